@@ -114,6 +114,23 @@ int main(int argc, char *argv[]) {
             // verify_file(filename, howmany);
         }
 
+        spdlog::info("");
+        spdlog::info("*********************************");
+        spdlog::info("Queue Overflow Policy: block (batch dequeue)");
+        spdlog::info("*********************************");
+        // same as above, but the worker takes up to 256 messages at once from the queue
+        // and writes them to the file with a single write
+        filename = "logs/basic_async-batch.log";
+        for (int i = 0; i < iters; i++) {
+            spdlog::thread_pool_options options;
+            options.max_batch_size = 256;
+            auto tp = std::make_shared<details::thread_pool>(queue_size, 1, options);
+            auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
+            auto logger = std::make_shared<async_logger>(
+                "async_logger", std::move(file_sink), std::move(tp), async_overflow_policy::block);
+            bench_mt(howmany, std::move(logger), threads);
+        }
+
         spdlog::info("");
         spdlog::info("*********************************");
         spdlog::info("Queue Overflow Policy: overrun");
@@ -128,6 +145,42 @@ int main(int argc, char *argv[]) {
                                                async_overflow_policy::overrun_oldest);
             bench_mt(howmany, std::move(logger), threads);
         }
+
+        // how the worker waits for messages, with each queue type
+        struct {
+            const char *name;
+            spdlog::async_queue_type type;
+        } queue_types[] = {{"mutex", spdlog::async_queue_type::mutex},
+                           {"lock_free", spdlog::async_queue_type::lock_free},
+                           {"per_thread", spdlog::async_queue_type::per_thread}};
+        struct {
+            const char *name;
+            spdlog::async_wait_policy policy;
+        } wait_policies[] = {{"block", spdlog::async_wait_policy::block},
+                             {"spin_yield_park", spdlog::async_wait_policy::spin_yield_park},
+                             {"busy_spin", spdlog::async_wait_policy::busy_spin}};
+        filename = "logs/basic_async-wait.log";
+        for (auto &queue_type : queue_types) {
+            for (auto &wait_policy : wait_policies) {
+                spdlog::info("");
+                spdlog::info("*********************************");
+                spdlog::info("Queue: {}, Wait Policy: {}", queue_type.name, wait_policy.name);
+                spdlog::info("*********************************");
+                for (int i = 0; i < iters; i++) {
+                    spdlog::thread_pool_options options;
+                    options.queue_type = queue_type.type;
+                    options.wait_policy = wait_policy.policy;
+                    options.max_batch_size = 256;
+                    auto tp = std::make_shared<details::thread_pool>(queue_size, 1, options);
+                    auto file_sink =
+                        std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
+                    auto logger =
+                        std::make_shared<async_logger>("async_logger", std::move(file_sink),
+                                                       std::move(tp), async_overflow_policy::block);
+                    bench_mt(howmany, std::move(logger), threads);
+                }
+            }
+        }
         spdlog::shutdown();
     } catch (std::exception &ex) {
         std::cerr << "Error: " << ex.what() << std::endl;
@@ -11,6 +11,12 @@
 #include "spdlog/sinks/daily_file_sink.h"
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
+#ifdef __linux__
+    #include "spdlog/sinks/io_uring_file_sink.h"
+#endif
+#ifndef _WIN32
+    #include "spdlog/sinks/mmap_rotating_file_sink.h"
+#endif
 
 #if defined(SPDLOG_USE_STD_FORMAT)
     #include <format>
@@ -23,6 +29,8 @@
 #include "utils.h"
 #include <atomic>
 #include <cstdlib>  // EXIT_FAILURE
+#include <ctime>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <thread>
@@ -35,8 +43,40 @@ void bench_mt(int howmany, std::shared_ptr<spdlog::logger> log, size_t thread_co
 
 static const size_t file_size = 30 * 1024 * 1024;
 static const size_t rotating_files = 5;
+static const size_t write_buffer_size = 1024 * 1024;
 static const int max_threads = 1000;
 
+// bytes on disk and cpu time per MB of log, plain and compressed
+void bench_compression(int iters) {
+    spdlog::info("**************************************************************");
+    spdlog::info("Compression: {} messages", iters);
+    spdlog::info("**************************************************************");
+
+    double log_mb = 0;  // the size of the plain log
+    for (bool compress : {false, true}) {
+        auto filename = compress ? "logs/compression.log.lz4" : "logs/compression.log";
+        spdlog::file_sink_options options;
+        options.compress = compress;
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(
+            filename, true, spdlog::file_event_handlers{}, options);
+        auto logger = std::make_shared<spdlog::logger>(filename, std::move(sink));
+        auto start = std::clock();
+        for (int i = 0; i < iters; ++i) {
+            logger->info("Hello logger: msg number {}", i);
+        }
+        logger.reset();  // closes the file
+        auto cpu_secs = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+        auto on_disk = static_cast<long long>(
+            std::ifstream(filename, std::ios::binary | std::ios::ate).tellg());
+        if (log_mb == 0) {
+            log_mb = static_cast<double>(on_disk) / (1024 * 1024);
+        }
+        spdlog::info("{:<30} {:>12} bytes on disk {:8.2f} ms cpu/MB", filename, on_disk,
+                     cpu_secs * 1000 / log_mb);
+    }
+}
+
 void bench_threaded_logging(size_t threads, int iters) {
     spdlog::info("**************************************************************");
     spdlog::info(spdlog::fmt_lib::format(
@@ -89,6 +129,18 @@ void bench_single_threaded(int iters) {
         spdlog::basic_logger_st("basic_st/backtrace-on", "logs/basic_st.log", true);
     bench(iters, std::move(basic_st_tracing));
 
+    // 1 MiB write buffer, written to the file without stdio
+    spdlog::file_sink_options buffered;
+    buffered.write_buffer_size = write_buffer_size;
+    auto basic_st_buffered = spdlog::basic_logger_st("basic_st/write-buffer", "logs/basic_st.log",
+                                                     true, spdlog::file_event_handlers{}, buffered);
+    bench(iters, std::move(basic_st_buffered));
+
+#ifdef __linux__
+    auto io_uring_st = spdlog::io_uring_logger_st("io_uring_st", "logs/io_uring_st.log", true);
+    bench(iters, std::move(io_uring_st));
+#endif
+
     spdlog::info("");
     auto rotating_st = spdlog::rotating_logger_st("rotating_st", "logs/rotating_st.log", file_size,
                                                   rotating_files);
@@ -97,6 +149,15 @@ void bench_single_threaded(int iters) {
         "rotating_st/backtrace-on", "logs/rotating_st.log", file_size, rotating_files);
     rotating_st_tracing->enable_backtrace(32);
     bench(iters, std::move(rotating_st_tracing));
+    auto rotating_st_buffered =
+        spdlog::rotating_logger_st("rotating_st/write-buffer", "logs/rotating_st.log", file_size,
+                                   rotating_files, false, spdlog::file_event_handlers{}, buffered);
+    bench(iters, std::move(rotating_st_buffered));
+#ifndef _WIN32
+    auto rotating_st_mmap = spdlog::mmap_rotating_logger_st(
+        "rotating_st/mmap", "logs/rotating_st_mmap.log", file_size, rotating_files);
+    bench(iters, std::move(rotating_st_mmap));
+#endif
 
     spdlog::info("");
     auto daily_st = spdlog::daily_logger_st("daily_st", "logs/daily_st.log");
@@ -135,6 +196,7 @@ int main(int argc, char *argv[]) {
         }
 
         bench_single_threaded(iters);
+        bench_compression(iters);
         bench_threaded_logging(1, iters);
         bench_threaded_logging(threads, iters);
     } catch (std::exception &ex) {
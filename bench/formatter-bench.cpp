@@ -7,6 +7,7 @@
 
 #include "spdlog/spdlog.h"
 #include "spdlog/pattern_formatter.h"
+#include "spdlog/details/fmt_helper.h"
 
 void bench_formatter(benchmark::State &state, std::string pattern) {
     auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>(pattern);
@@ -25,6 +26,54 @@ void bench_formatter(benchmark::State &state, std::string pattern) {
     }
 }
 
+// a new second (and fraction) on every message, so the time fields are rendered each time
+void bench_time_formatter(benchmark::State &state, std::string pattern) {
+    auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>(pattern);
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    spdlog::details::log_msg msg(logger_name, spdlog::level::info, "message");
+
+    for (auto _ : state) {
+        msg.time += std::chrono::nanoseconds(1000123457);
+        dest.clear();
+        formatter->format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+using render_digits = void (*)(uint32_t n, spdlog::memory_buf_t &dest);
+
+void bench_digits(benchmark::State &state, render_digits render) {
+    spdlog::memory_buf_t dest;
+    uint32_t n = 0;
+    for (auto _ : state) {
+        n = n * 1664525u + 1013904223u;
+        dest.clear();
+        render(n, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+void pad2_digits(uint32_t n, spdlog::memory_buf_t &dest) {
+    spdlog::details::fmt_helper::pad2(static_cast<int>(n % 100), dest);
+}
+
+void pad3_digits(uint32_t n, spdlog::memory_buf_t &dest) {
+    spdlog::details::fmt_helper::pad3(n % 1000, dest);
+}
+
+void pad6_digits(uint32_t n, spdlog::memory_buf_t &dest) {
+    spdlog::details::fmt_helper::pad6(n % 1000000, dest);
+}
+
+void pad9_digits(uint32_t n, spdlog::memory_buf_t &dest) {
+    spdlog::details::fmt_helper::pad9(n % 1000000000, dest);
+}
+
+void append_int_digits(uint32_t n, spdlog::memory_buf_t &dest) {
+    spdlog::details::fmt_helper::append_int(n, dest);
+}
+
 void bench_formatters() {
     // basic patterns(single flag)
     std::string all_flags = "+vtPnlLaAbBcCYDmdHIMSefFprRTXzEisg@luioO%";
@@ -41,11 +90,30 @@ void bench_formatters() {
         //        benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
     }
 
+    // time flags, rendered on every message
+    std::string time_flags = "YDmdHIMSefFprRTXzEcC+";
+    for (auto &flag : time_flags) {
+        auto pattern = std::string("%") + flag;
+        benchmark::RegisterBenchmark((pattern + "/new_second").c_str(), &bench_time_formatter,
+                                     pattern);
+    }
+    benchmark::RegisterBenchmark("%Y-%m-%d %H:%M:%S.%F/new_second", &bench_time_formatter,
+                                 "%Y-%m-%d %H:%M:%S.%F");
+
+    // digit rendering
+    benchmark::RegisterBenchmark("fmt_helper::pad2", &bench_digits, &pad2_digits);
+    benchmark::RegisterBenchmark("fmt_helper::pad3", &bench_digits, &pad3_digits);
+    benchmark::RegisterBenchmark("fmt_helper::pad6", &bench_digits, &pad6_digits);
+    benchmark::RegisterBenchmark("fmt_helper::pad9", &bench_digits, &pad9_digits);
+    benchmark::RegisterBenchmark("fmt_helper::append_int", &bench_digits, &append_int_digits);
+
     // complex patterns
     std::vector<std::string> patterns = {
         "[%D %X] [%l] [%n] %v",
         "[%Y-%m-%d %H:%M:%S.%e] [%l] [%n] %v",
         "[%Y-%m-%d %H:%M:%S.%e] [%l] [%n] [%t] %v",
+        "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v",
+        "[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v",
     };
     for (auto &pattern : patterns) {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern)
@@ -39,6 +39,27 @@ void bench_logger(benchmark::State &state, std::shared_ptr<spdlog::logger> logge
         logger->info("Hello logger: msg number {}...............", ++i);
     }
 }
+// runtime vs compile-time parsing of the same format string
+void bench_runtime_format(benchmark::State &state, std::shared_ptr<spdlog::logger> logger) {
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        logger->info("Hello logger: msg number {} ({:.3f}) from {}...", i, i * 0.5, "bench");
+    }
+}
+
+// needs SPDLOG_COMPILED_FORMAT (cmake option), for the whole build
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+void bench_compiled_format(benchmark::State &state, std::shared_ptr<spdlog::logger> logger) {
+    int i = 0;
+    for (auto _ : state) {
+        ++i;
+        logger->info(FMT_COMPILE("Hello logger: msg number {} ({:.3f}) from {}..."), i, i * 0.5,
+                     "bench");
+    }
+}
+#endif
+
 void bench_global_logger(benchmark::State &state, std::shared_ptr<spdlog::logger> logger) {
     spdlog::set_default_logger(std::move(logger));
     int i = 0;
@@ -115,6 +136,12 @@ int main(int argc, char *argv[]) {
     benchmark::RegisterBenchmark("null_sink_st", bench_logger, null_logger_st);
     benchmark::RegisterBenchmark("null_sink_st (global logger)", bench_global_logger,
                                  null_logger_st);
+    benchmark::RegisterBenchmark("null_sink_st/runtime_format", bench_runtime_format,
+                                 null_logger_st);
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+    benchmark::RegisterBenchmark("null_sink_st/compiled_format", bench_compiled_format,
+                                 null_logger_st);
+#endif
     // with backtrace of 64
     auto tracing_null_logger_st =
         std::make_shared<spdlog::logger>("bench", std::make_shared<null_sink_st>());
@@ -215,6 +242,63 @@ int main(int argc, char *argv[]) {
         ->Threads(n_threads)
         ->UseRealTime();
 
+    // async with lock free queue
+    spdlog::thread_pool_options lockfree_options;
+    lockfree_options.queue_type = spdlog::async_queue_type::lock_free;
+    auto lockfree_tp =
+        std::make_shared<spdlog::details::thread_pool>(queue_size, 1, lockfree_options);
+    auto async_logger_lockfree = std::make_shared<spdlog::async_logger>(
+        "async_logger_lockfree", std::make_shared<null_sink_mt>(), std::move(lockfree_tp),
+        spdlog::async_overflow_policy::overrun_oldest);
+    benchmark::RegisterBenchmark("async_logger/lock_free", bench_logger, async_logger_lockfree)
+        ->Threads(n_threads)
+        ->UseRealTime();
+
+    // async with lock free queue and logger handles (no shared_ptr copies when logging)
+    lockfree_options.logger_handles = true;
+    auto handles_tp =
+        std::make_shared<spdlog::details::thread_pool>(queue_size, 1, lockfree_options);
+    auto async_logger_handles = std::make_shared<spdlog::async_logger>(
+        "async_logger_handles", std::make_shared<null_sink_mt>(), std::move(handles_tp),
+        spdlog::async_overflow_policy::overrun_oldest);
+    benchmark::RegisterBenchmark("async_logger/lock_free/handles", bench_logger,
+                                 async_logger_handles)
+        ->Threads(n_threads)
+        ->UseRealTime();
+
+    // async with lock free queue, formatting on the worker
+    auto async_logger_deferred = std::make_shared<spdlog::async_logger>(
+        "async_logger_deferred", std::make_shared<null_sink_mt>(), lockfree_tp,
+        spdlog::async_overflow_policy::overrun_oldest);
+    async_logger_deferred->set_deferred_formatting(true);
+    benchmark::RegisterBenchmark("async_logger/lock_free/deferred", bench_logger,
+                                 async_logger_deferred)
+        ->Threads(n_threads)
+        ->UseRealTime();
+
+    // async with per thread queues (the queue size is per thread)
+    spdlog::thread_pool_options per_thread_options;
+    per_thread_options.queue_type = spdlog::async_queue_type::per_thread;
+    auto per_thread_tp =
+        std::make_shared<spdlog::details::thread_pool>(8192, 1, per_thread_options);
+    auto async_logger_per_thread = std::make_shared<spdlog::async_logger>(
+        "async_logger_per_thread", std::make_shared<null_sink_mt>(), std::move(per_thread_tp),
+        spdlog::async_overflow_policy::overrun_oldest);
+    benchmark::RegisterBenchmark("async_logger/per_thread", bench_logger, async_logger_per_thread)
+        ->Threads(n_threads)
+        ->UseRealTime();
+
+    // async with the payloads written in place in an arena
+    spdlog::thread_pool_options arena_options;
+    arena_options.queue_type = spdlog::async_queue_type::arena;
+    auto arena_tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, arena_options);
+    auto async_logger_arena = std::make_shared<spdlog::async_logger>(
+        "async_logger_arena", std::make_shared<null_sink_mt>(), std::move(arena_tp),
+        spdlog::async_overflow_policy::overrun_oldest);
+    benchmark::RegisterBenchmark("async_logger/arena", bench_logger, async_logger_arena)
+        ->Threads(n_threads)
+        ->UseRealTime();
+
     benchmark::Initialize(&argc, argv);
     benchmark::RunSpecifiedBenchmarks();
 }
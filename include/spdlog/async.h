@@ -76,18 +76,34 @@ inline std::shared_ptr<spdlog::logger> create_async_nb(std::string logger_name,
 inline void init_thread_pool(size_t q_size,
                              size_t thread_count,
                              std::function<void()> on_thread_start,
-                             std::function<void()> on_thread_stop) {
+                             std::function<void()> on_thread_stop,
+                             const thread_pool_options &options) {
     auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, on_thread_start,
-                                                     on_thread_stop);
+                                                     on_thread_stop, options);
     details::registry::instance().set_tp(std::move(tp));
 }
 
+inline void init_thread_pool(size_t q_size,
+                             size_t thread_count,
+                             std::function<void()> on_thread_start,
+                             std::function<void()> on_thread_stop) {
+    init_thread_pool(q_size, thread_count, on_thread_start, on_thread_stop,
+                     thread_pool_options{});
+}
+
 inline void init_thread_pool(size_t q_size,
                              size_t thread_count,
                              std::function<void()> on_thread_start) {
     init_thread_pool(q_size, thread_count, on_thread_start, [] {});
 }
 
+inline void init_thread_pool(size_t q_size,
+                             size_t thread_count,
+                             const thread_pool_options &options) {
+    init_thread_pool(
+        q_size, thread_count, [] {}, [] {}, options);
+}
+
 inline void init_thread_pool(size_t q_size, size_t thread_count) {
     init_thread_pool(
         q_size, thread_count, [] {}, [] {});
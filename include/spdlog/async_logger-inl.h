@@ -10,8 +10,10 @@
 #include <spdlog/details/thread_pool.h>
 #include <spdlog/sinks/sink.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 SPDLOG_INLINE spdlog::async_logger::async_logger(std::string logger_name,
                                                  sinks_init_list sinks_list,
@@ -30,22 +32,55 @@ SPDLOG_INLINE spdlog::async_logger::async_logger(std::string logger_name,
     : async_logger(
           std::move(logger_name), {std::move(single_sink)}, std::move(tp), overflow_policy) {}
 
+SPDLOG_INLINE spdlog::async_logger::async_logger(const async_logger &other)
+    : std::enable_shared_from_this<async_logger>(),
+      logger(other),
+      thread_pool_(other.thread_pool_),
+      overflow_policy_(other.overflow_policy_) {
+    register_with_pool_();
+}
+
+SPDLOG_INLINE spdlog::async_logger::~async_logger() {
+    if (registered_pool_) {
+        SPDLOG_TRY { registered_pool_->unregister_logger_(handle_); }
+        SPDLOG_CATCH_STD
+    }
+}
+
 // send the log message to the thread pool
-SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg){
-    SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
-        pool_ptr->post_log(shared_from_this(), msg, overflow_policy_);
+SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg) {
+    post_log_(msg, false);
 }
-else {
-    throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+
+// send the captured arguments to the thread pool, to be formatted there
+SPDLOG_INLINE void spdlog::async_logger::sink_deferred_(const details::log_msg &msg) {
+    post_log_(msg, true);
 }
+
+SPDLOG_INLINE void spdlog::async_logger::set_deferred_formatting(bool enabled) {
+    deferred_formatting_ = enabled;
 }
-SPDLOG_LOGGER_CATCH(msg.source)
+
+SPDLOG_INLINE void spdlog::async_logger::post_log_(const details::log_msg &msg, bool deferred) {
+    auto msg_type = deferred ? details::async_msg_type::log_deferred : details::async_msg_type::log;
+    SPDLOG_TRY {
+        if (registered_pool_) {
+            registered_pool_->post_log(handle_, msg, overflow_policy_, msg_type);
+        } else if (auto pool_ptr = thread_pool_.lock()) {
+            pool_ptr->post_log(shared_from_this(), msg, overflow_policy_, msg_type);
+        } else {
+            throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+        }
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
 }
 
 // send flush request to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::flush_(){
-    SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
-        pool_ptr->post_flush(shared_from_this(), overflow_policy_);
+    SPDLOG_TRY{if (registered_pool_){registered_pool_->post_flush(handle_, overflow_policy_);
+}
+else if (auto pool_ptr = thread_pool_.lock()) {
+    pool_ptr->post_flush(shared_from_this(), overflow_policy_);
 }
 else {
     throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
@@ -58,9 +93,18 @@ SPDLOG_LOGGER_CATCH(source_loc())
 // backend functions - called from the thread pool to do the actual job
 //
 SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg &msg) {
+    // sinks with equivalent formatters format the message once
+    sinks::shared_format shared;
+    bool share_format = sinks_.size() > 1;
     for (auto &sink : sinks_) {
         if (sink->should_log(msg.level)) {
-            SPDLOG_TRY { sink->log(msg); }
+            SPDLOG_TRY {
+                if (share_format) {
+                    sink->log_shared(msg, shared);
+                } else {
+                    sink->log(msg);
+                }
+            }
             SPDLOG_LOGGER_CATCH(msg.source)
         }
     }
@@ -70,6 +114,59 @@ SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg
     }
 }
 
+// pass a batch of messages to each sink at once.
+// sinks that filter out some of the messages get only the ones they should log.
+// the sinks that get the whole batch and have equivalent formatters format it once.
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(const details::log_msg *const *msgs,
+                                                             size_t count) {
+    auto min_level = level::off;
+    bool flush_needed = false;
+    for (size_t i = 0; i < count; i++) {
+        min_level = (std::min)(min_level, msgs[i]->level);
+        flush_needed = flush_needed || should_flush_(*msgs[i]);
+    }
+
+    std::vector<const details::log_msg *> filtered;
+    sinks::shared_format shared;
+    bool share_format = sinks_.size() > 1;
+    for (auto &sink : sinks_) {
+        SPDLOG_TRY {
+            if (sink->should_log(min_level)) {
+                if (share_format) {
+                    sink->log_batch_shared(msgs, count, shared);
+                } else {
+                    sink->log_batch(msgs, count);
+                }
+                continue;
+            }
+            filtered.clear();
+            for (size_t i = 0; i < count; i++) {
+                if (sink->should_log(msgs[i]->level)) {
+                    filtered.push_back(msgs[i]);
+                }
+            }
+            if (!filtered.empty()) {
+                sink->log_batch(filtered.data(), filtered.size());
+            }
+        }
+        SPDLOG_LOGGER_CATCH(msgs[0]->source)
+    }
+
+    if (flush_needed) {
+        backend_flush_();
+    }
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::backend_format_(memory_buf_t &dest,
+                                                         const details::log_msg &msg) {
+    SPDLOG_TRY {
+        details::format_deferred(dest, msg.payload);
+        return true;
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
+    return false;
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -77,6 +174,20 @@ SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
     }
 }
 
+// pick the queue of the pool to post to (thread_pool_options::sharded),
+// and get a handle from the pool if it uses them (thread_pool_options::logger_handles)
+SPDLOG_INLINE void spdlog::async_logger::register_with_pool_() {
+    auto pool_ptr = thread_pool_.lock();
+    if (!pool_ptr) {
+        return;
+    }
+    shard_ = pool_ptr->shard_of_(sinks_);
+    if (pool_ptr->logger_handles_) {
+        handle_ = pool_ptr->register_logger_(this);
+        registered_pool_ = std::move(pool_ptr);
+    }
+}
+
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name) {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
     cloned->name_ = std::move(new_name);
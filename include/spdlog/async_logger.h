@@ -43,7 +43,9 @@ public:
                  async_overflow_policy overflow_policy = async_overflow_policy::block)
         : logger(std::move(logger_name), begin, end),
           thread_pool_(std::move(tp)),
-          overflow_policy_(overflow_policy) {}
+          overflow_policy_(overflow_policy) {
+        register_with_pool_();
+    }
 
     async_logger(std::string logger_name,
                  sinks_init_list sinks_list,
@@ -55,17 +57,43 @@ public:
                  std::weak_ptr<details::thread_pool> tp,
                  async_overflow_policy overflow_policy = async_overflow_policy::block);
 
+    async_logger(const async_logger &other);
+    async_logger &operator=(const async_logger &) = delete;
+
+    // wait for the thread pool to log the remaining messages if registered with it
+    ~async_logger() override;
+
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // format the messages on the worker threads instead of the calling thread.
+    // only messages whose arguments are arithmetic types, void pointers or strings are deferred,
+    // the others (and all messages while backtrace is enabled) are formatted right away.
+    // the arguments are copied, so they may change or be destroyed once the log call returns.
+    // call it before logging (not thread safe).
+    void set_deferred_formatting(bool enabled);
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_deferred_(const details::log_msg &msg) override;
     void flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    void backend_sink_batch_(const details::log_msg *const *msgs, size_t count);
     void backend_flush_();
+    // format a log_deferred message. return false on error (reported to the error handler).
+    bool backend_format_(memory_buf_t &dest, const details::log_msg &msg);
 
 private:
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+    // set if the pool uses logger handles (thread_pool_options::logger_handles):
+    // the messages carry handle_ instead of a shared_ptr to this logger
+    std::shared_ptr<details::thread_pool> registered_pool_;
+    size_t handle_ = 0;
+    // queue of the pool this logger posts to (thread_pool_options::sharded)
+    size_t shard_ = 0;
+
+    void register_with_pool_();
+    void post_log_(const details::log_msg &msg, bool deferred);
 };
 }  // namespace spdlog
 
@@ -49,6 +49,10 @@
 
 #include <spdlog/fmt/fmt.h>
 
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+    #include <spdlog/fmt/compile.h>
+#endif
+
 #if !defined(SPDLOG_USE_STD_FORMAT) && \
     FMT_VERSION >= 80000  // backward compatibility with fmt versions older than 8
     #define SPDLOG_FMT_RUNTIME(format_string) fmt::runtime(format_string)
@@ -222,6 +226,15 @@ struct is_convertible_to_any_format_string
                              is_convertible_to_basic_format_string<T, char>::value ||
                                  is_convertible_to_basic_format_string<T, wchar_t>::value> {};
 
+// format strings made with FMT_COMPILE (see SPDLOG_COMPILED_FORMAT)
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+template <class T>
+struct is_compiled_format_string : fmt::detail::is_compiled_string<T> {};
+#else
+template <class T>
+struct is_compiled_format_string : std::false_type {};
+#endif
+
 #if defined(SPDLOG_NO_ATOMIC_LEVELS)
 using level_t = details::null_atomic_int;
 #else
@@ -296,6 +309,15 @@ enum class pattern_time_type {
     utc     // log utc
 };
 
+//
+// How the async workers wait for new messages (see thread_pool_options).
+//
+enum class async_wait_policy {
+    block,            // sleep until a producer wakes them up (default)
+    spin_yield_park,  // retry a little, then yield the cpu, then sleep
+    busy_spin         // never sleep: lowest latency, but each worker keeps a core busy
+};
+
 //
 // Log exception
 //
@@ -338,6 +360,22 @@ struct file_event_handlers {
     std::function<void(const filename_t &filename)> after_close;
 };
 
+// Optional settings of the file sinks (basic, rotating and daily)
+struct file_sink_options {
+    // gather the lines in a buffer of this size, written to the file bypassing stdio when it's
+    // full, on flush or on rotation (see details::file_helper). 0 to write through stdio.
+    size_t write_buffer_size = 0;
+    // write the file compressed in the lz4 frame format (see details::file_helper, name it e.g.
+    // log.lz4). the blocks are compressed on the logging thread: use an async logger to keep it
+    // off the producers, or compress_rotated to compress only the closed files, in the background.
+    bool compress = false;
+    // rotating and daily sinks: compress the closed files to <filename>.lz4 on a background thread
+    // (see details::lz4_compress_file)
+    bool compress_rotated = false;
+    // rotating sink: rename the older files on a background thread
+    bool background_rotation = false;
+};
+
 namespace details {
 
 // to_string_view
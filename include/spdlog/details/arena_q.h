@@ -0,0 +1,310 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer blocking queue of variable length records.
+// Each record is an item of type T followed by extra bytes (e.g. the log payload), both written
+// in place in a preallocated ring of bytes. Nothing is allocated after construction.
+//
+// enqueue(..) - will block until room found to put the new record.
+// enqueue_nowait(..) - will drop the oldest records if no room left.
+// enqueue_if_have_room(..) - will discard the new record if no room left.
+// dequeue_bulk(..) - will block until the queue is not empty, then claim up to a limit of records.
+// release(..) - destroy the claimed records and make their room available again.
+//
+// Claimed records stay in place until released, so consumers work on them without copying.
+// Records bigger than the whole arena are discarded.
+// The consumers wait according to the async_wait_policy, as in mpmc_blocking_queue.
+
+#include <spdlog/common.h>
+#include <spdlog/details/parking_spot.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+template <typename T>
+class arena_queue {
+public:
+    struct record {
+        size_t size;  // total size of the record, padded to the alignment of record
+        bool skip;    // the rest of the arena is unused, next record is at the start
+        bool done;    // released by its consumer
+        size_t extra_size;
+        T item;
+
+        const char *extra() const { return reinterpret_cast<const char *>(this + 1); }
+        char *extra() { return reinterpret_cast<char *>(this + 1); }
+    };
+
+    explicit arena_queue(size_t capacity_bytes,
+                         async_wait_policy wait_policy = async_wait_policy::block)
+        : blocks_(new block[capacity_bytes / sizeof(block)]),
+          capacity_(capacity_bytes / sizeof(block) * sizeof(block)),
+          wait_policy_(wait_policy) {}
+
+    ~arena_queue() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        while (unclaimed_ > 0) {
+            release_(claim_());
+        }
+    }
+
+    arena_queue(const arena_queue &) = delete;
+    arena_queue &operator=(const arena_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item, const char *extra, size_t extra_size) {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            size_t size = record_size_(extra_size);
+            if (size > capacity_) {
+                discard_counter_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            record *rec;
+            producers_waiting_++;
+            pop_cv_.wait(lock, [&] { return (rec = reserve_(size)) != nullptr; });
+            producers_waiting_--;
+            notify = construct_(rec, size, std::move(item), extra, extra_size);
+        }
+        if (notify) {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue immediately. drop the oldest records if no room left.
+    // may wait for the consumers to release the records they are working on.
+    void enqueue_nowait(T &&item, const char *extra, size_t extra_size) {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            size_t size = record_size_(extra_size);
+            if (size > capacity_) {
+                overrun_counter_++;
+                return;
+            }
+            record *rec;
+            while ((rec = reserve_(size)) == nullptr) {
+                if (claimed_ == 0 && unclaimed_ > 0) {
+                    release_(claim_());
+                    overrun_counter_++;
+                } else {
+                    producers_waiting_++;
+                    pop_cv_.wait(lock);
+                    producers_waiting_--;
+                }
+            }
+            notify = construct_(rec, size, std::move(item), extra, extra_size);
+        }
+        if (notify) {
+            push_cv_.notify_one();
+        }
+    }
+
+    void enqueue_if_have_room(T &&item, const char *extra, size_t extra_size) {
+        bool pushed = false;
+        bool notify = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            record *rec = reserve_(record_size_(extra_size));
+            if (rec != nullptr) {
+                notify = construct_(rec, record_size_(extra_size), std::move(item), extra,
+                                    extra_size);
+                pushed = true;
+            }
+        }
+
+        if (notify) {
+            push_cv_.notify_one();
+        }
+        if (!pushed) {
+            discard_counter_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // blocking claim of up to max_count records at once.
+    // Return the number of records put in claimed (at least one).
+    size_t dequeue_bulk(record **claimed, size_t max_count) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        wait_not_empty_(lock);
+        size_t count = 0;
+        while (count < max_count && unclaimed_ > 0) {
+            claimed[count++] = claim_();
+        }
+        return count;
+    }
+
+    // destroy claimed records and free their room
+    void release(record *const *claimed, size_t count) {
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            for (size_t i = 0; i < count; i++) {
+                release_(claimed[i]);
+            }
+            notify = producers_waiting_ > 0;
+        }
+        if (notify) {
+            pop_cv_.notify_all();
+        }
+    }
+
+    size_t overrun_counter() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return overrun_counter_;
+    }
+
+    size_t discard_counter() { return discard_counter_.load(std::memory_order_relaxed); }
+
+    // number of records waiting to be claimed
+    size_t size() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return unclaimed_;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    void reset_overrun_counter() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        overrun_counter_ = 0;
+    }
+
+    void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
+
+private:
+    using block = typename std::aligned_storage<sizeof(record), alignof(record)>::type;
+
+    static size_t record_size_(size_t extra_size) {
+        size_t size = sizeof(record) + extra_size;
+        return (size + alignof(record) - 1) / alignof(record) * alignof(record);
+    }
+
+    record *at_(size_t offset) {
+        return reinterpret_cast<record *>(reinterpret_cast<char *>(blocks_.get()) + offset);
+    }
+
+    // offset of the record at the given position, after skipping the unused end of the arena
+    size_t normalize_(size_t offset) {
+        if (capacity_ - offset < sizeof(record) || at_(offset)->skip) {
+            return 0;
+        }
+        return offset;
+    }
+
+    // find room for size bytes at the tail. return nullptr if no room left.
+    record *reserve_(size_t size) {
+        if (used_ == 0) {
+            head_ = read_ = tail_ = 0;
+        }
+        if (tail_ < head_ || (tail_ == head_ && used_ > 0)) {
+            return head_ - tail_ >= size ? at_(tail_) : nullptr;
+        }
+        if (capacity_ - tail_ >= size) {
+            return at_(tail_);
+        }
+        if (head_ < size) {
+            return nullptr;
+        }
+        // not enough room at the end, continue at the start
+        if (capacity_ - tail_ >= sizeof(record)) {
+            at_(tail_)->skip = true;
+        }
+        used_ += capacity_ - tail_;
+        tail_ = 0;
+        return at_(tail_);
+    }
+
+    // return true if a consumer is sleeping and must be notified
+    bool construct_(record *rec, size_t size, T &&item, const char *extra, size_t extra_size) {
+        new (&rec->item) T(std::move(item));
+        rec->size = size;
+        rec->skip = false;
+        rec->done = false;
+        rec->extra_size = extra_size;
+        if (extra_size > 0) {
+            std::memcpy(rec->extra(), extra, extra_size);
+        }
+        tail_ += size;
+        used_ += size;
+        unclaimed_++;
+        has_items_.store(true, std::memory_order_relaxed);
+        return consumers_waiting_ > 0;
+    }
+
+    record *claim_() {
+        read_ = normalize_(read_);
+        auto *rec = at_(read_);
+        read_ += rec->size;
+        unclaimed_--;
+        claimed_++;
+        has_items_.store(unclaimed_ > 0, std::memory_order_relaxed);
+        return rec;
+    }
+
+    // wait for unclaimed records. spin without the lock first, as allowed by the policy.
+    void wait_not_empty_(std::unique_lock<std::mutex> &lock) {
+        bool spun = false;
+        while (unclaimed_ == 0) {
+            if (wait_policy_ == async_wait_policy::busy_spin ||
+                (wait_policy_ == async_wait_policy::spin_yield_park && !spun)) {
+                lock.unlock();
+                parking_spot::spin(
+                    [this] { return this->has_items_.load(std::memory_order_relaxed); },
+                    wait_policy_);
+                lock.lock();
+                spun = true;
+                continue;
+            }
+            consumers_waiting_++;
+            push_cv_.wait(lock, [this] { return this->unclaimed_ > 0; });
+            consumers_waiting_--;
+        }
+    }
+
+    // free the room of the released records at the head, in order
+    void release_(record *rec) {
+        rec->item.~T();
+        rec->done = true;
+        while (claimed_ > 0) {
+            size_t offset = normalize_(head_);
+            auto *head_rec = at_(offset);
+            if (!head_rec->done) {
+                break;
+            }
+            used_ -= (offset == head_ ? 0 : capacity_ - head_) + head_rec->size;
+            head_ = offset + head_rec->size;
+            claimed_--;
+        }
+    }
+
+    std::unique_ptr<block[]> blocks_;
+    const size_t capacity_;
+    size_t head_ = 0;  // oldest record not released yet
+    size_t read_ = 0;  // oldest record not claimed yet
+    size_t tail_ = 0;  // where the next record goes
+    size_t used_ = 0;  // bytes between head_ and tail_, including the unused end of the arena
+    size_t unclaimed_ = 0;
+    size_t claimed_ = 0;  // claimed, but not yet freed from the head
+    size_t overrun_counter_ = 0;
+    std::atomic<size_t> discard_counter_{0};
+    std::mutex queue_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+    const async_wait_policy wait_policy_;
+    // threads sleeping on push_cv_ / pop_cv_
+    size_t consumers_waiting_ = 0;
+    size_t producers_waiting_ = 0;
+    // hint for the spinning consumers, read without the lock
+    std::atomic<bool> has_items_{false};
+};
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,89 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/background_worker.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE background_worker::~background_worker() {
+    if (worker_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        worker_thread_.join();
+    }
+}
+
+SPDLOG_INLINE void background_worker::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+        if (!worker_thread_.joinable()) {
+            worker_thread_ = std::thread([this] { worker_loop_(); });
+        }
+    }
+    cv_.notify_one();
+}
+
+SPDLOG_INLINE void background_worker::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+SPDLOG_INLINE void background_worker::rethrow_error() {
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_.empty()) {
+            return;
+        }
+        std::swap(error, error_);
+    }
+    throw_spdlog_ex(std::move(error));
+}
+
+// the pending jobs are done before stopping
+SPDLOG_INLINE void background_worker::worker_loop_() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+            return;  // stop_ == true
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        busy_ = true;
+        lock.unlock();
+#ifdef SPDLOG_NO_EXCEPTIONS
+        job();
+        lock.lock();
+#else
+        std::string error;
+        try {
+            job();
+        } catch (const std::exception &ex) {
+            error = ex.what();
+        } catch (...) {
+            error = "unknown exception in background job";
+        }
+        lock.lock();
+        if (error_.empty()) {
+            error_ = std::move(error);
+        }
+#endif
+        busy_ = false;
+        if (jobs_.empty()) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,59 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// background worker thread - executes the posted jobs one after the other, in order.
+//
+// the thread is created on the first post().
+// on destruction, finishes the pending jobs, then joins the thread.
+// a job that throws doesn't stop the worker: the first error is kept, and rethrown by
+// rethrow_error() (on the thread that calls it).
+
+#include <spdlog/common.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API background_worker {
+public:
+    background_worker() = default;
+    background_worker(const background_worker &) = delete;
+    background_worker &operator=(const background_worker &) = delete;
+    // finish the pending jobs and join the thread
+    ~background_worker();
+
+    void post(std::function<void()> job);
+
+    // wait until the posted jobs are done
+    void wait();
+
+    // throw the first error of the jobs since the last call, if any
+    void rethrow_error();
+
+private:
+    void worker_loop_();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::deque<std::function<void()>> jobs_;
+    bool busy_ = false;
+    bool stop_ = false;
+    std::string error_;
+    std::thread worker_thread_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "background_worker-inl.h"
+#endif
@@ -62,6 +62,12 @@ public:
 
     T &front() { return v_[head_]; }
 
+    // Return reference to the back item.
+    // If there are no elements in the container, the behavior is undefined.
+    const T &back() const { return v_[(tail_ + max_items_ - 1) % max_items_]; }
+
+    T &back() { return v_[(tail_ + max_items_ - 1) % max_items_]; }
+
     // Return number of elements actually stored
     size_t size() const {
         if (tail_ >= head_) {
@@ -0,0 +1,67 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Helpers for the format strings compiled with FMT_COMPILE (see SPDLOG_COMPILED_FORMAT).
+//
+// format_size_hint() estimates the formatted size of a message from its format string and the
+// types of its arguments, so the buffer can be reserved once before formatting.
+
+#include <spdlog/common.h>
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+SPDLOG_CONSTEXPR size_t arg_size_hint(const T &) {
+    return static_cast<size_t>(std::numeric_limits<T>::digits10) + 2;  // sign and extra digit
+}
+
+template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+SPDLOG_CONSTEXPR size_t arg_size_hint(const T &) {
+    return static_cast<size_t>(std::numeric_limits<T>::max_digits10) + 8;  // sign, dot, exponent
+}
+
+// string literals
+template <size_t N>
+SPDLOG_CONSTEXPR size_t arg_size_hint(const char (&)[N]) {
+    return N;
+}
+
+// strings that know their size. C strings would need an extra pass over them.
+template <typename T,
+          typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_array<T>::value &&
+                                      !std::is_pointer<T>::value &&
+                                      std::is_convertible<const T &, string_view_t>::value,
+                                  int>::type = 0>
+size_t arg_size_hint(const T &value) {
+    return string_view_t(value).size();
+}
+
+// anything else
+template <typename T,
+          typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_array<T>::value &&
+                                      (std::is_pointer<T>::value ||
+                                       !std::is_convertible<const T &, string_view_t>::value),
+                                  int>::type = 0>
+SPDLOG_CONSTEXPR size_t arg_size_hint(const T &) {
+    return 16;
+}
+
+template <typename S, typename... Args>
+size_t format_size_hint(const S &fmt, const Args &...args) {
+    size_t sizes[] = {static_cast<string_view_t>(fmt).size(), arg_size_hint(args)...};
+    size_t rv = 0;
+    for (auto size : sizes) {
+        rv += size;
+    }
+    return rv;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,198 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Deferred formatting: capture the format string and the arguments of a log call in a buffer, and
+// format them later, on another thread (see async_logger::set_deferred_formatting()).
+//
+// The buffer holds a pointer to the function that knows the types of the arguments, the format
+// string and the arguments. Arithmetic types and void pointers are copied as is, strings are
+// copied by value and formatted back from string views. Other types can't be captured: the
+// messages using them are formatted right away.
+//
+// Note: C strings are captured as strings, so they can't be formatted as pointers ("{:p}").
+
+#include <spdlog/common.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+// format the captured arguments that follow the function pointer
+using deferred_format_fn = void (*)(memory_buf_t &dest, const char *data);
+
+template <typename T>
+struct deferred_is_scalar {
+    using decayed = typename std::decay<T>::type;
+    static SPDLOG_CONSTEXPR bool value = std::is_arithmetic<decayed>::value ||
+                                         std::is_same<decayed, const void *>::value ||
+                                         std::is_same<decayed, void *>::value ||
+                                         std::is_same<decayed, std::nullptr_t>::value;
+};
+
+template <typename T>
+struct deferred_is_c_string {
+    using decayed = typename std::decay<T>::type;
+    static SPDLOG_CONSTEXPR bool value =
+        std::is_same<decayed, const char *>::value || std::is_same<decayed, char *>::value;
+};
+
+template <typename T>
+struct deferred_is_string {
+    using decayed = typename std::decay<T>::type;
+    static SPDLOG_CONSTEXPR bool value = std::is_same<decayed, std::string>::value ||
+#if defined(__cpp_lib_string_view) && !defined(SPDLOG_USE_STD_FORMAT)
+                                         std::is_same<decayed, std::string_view>::value ||
+#endif
+                                         std::is_same<decayed, string_view_t>::value;
+};
+
+inline void deferred_write_bytes(memory_buf_t &buf, const void *data, size_t size) {
+    auto *begin = static_cast<const char *>(data);
+    buf.append(begin, begin + size);
+}
+
+inline void deferred_write_string(memory_buf_t &buf, string_view_t value) {
+    size_t size = value.size();
+    deferred_write_bytes(buf, &size, sizeof(size));
+    deferred_write_bytes(buf, value.data(), size);
+}
+
+// how an argument of type T is captured. stored_type is the type it is formatted from.
+template <typename T, typename = void>
+struct deferred_arg {
+    static SPDLOG_CONSTEXPR bool supported = false;
+};
+
+template <typename T>
+struct deferred_arg<T, typename std::enable_if<deferred_is_scalar<T>::value>::type> {
+    static SPDLOG_CONSTEXPR bool supported = true;
+    using stored_type = typename std::decay<T>::type;
+
+    static bool write(memory_buf_t &buf, const stored_type &value) {
+        deferred_write_bytes(buf, &value, sizeof(value));
+        return true;
+    }
+};
+
+template <typename T>
+struct deferred_arg<T, typename std::enable_if<deferred_is_c_string<T>::value>::type> {
+    static SPDLOG_CONSTEXPR bool supported = true;
+    using stored_type = string_view_t;
+
+    // a null string is left to the formatter to report, on the calling thread
+    static bool write(memory_buf_t &buf, const char *value) {
+        if (value == nullptr) {
+            return false;
+        }
+        deferred_write_string(buf, value);
+        return true;
+    }
+};
+
+template <typename T>
+struct deferred_arg<T, typename std::enable_if<deferred_is_string<T>::value>::type> {
+    static SPDLOG_CONSTEXPR bool supported = true;
+    using stored_type = string_view_t;
+
+    static bool write(memory_buf_t &buf, string_view_t value) {
+        deferred_write_string(buf, value);
+        return true;
+    }
+};
+
+template <typename... Args>
+struct deferrable : std::true_type {};
+
+template <typename T, typename... Rest>
+struct deferrable<T, Rest...>
+    : std::integral_constant<bool, deferred_arg<T>::supported && deferrable<Rest...>::value> {};
+
+inline const char *deferred_read(const char *data, string_view_t &value) {
+    size_t size;
+    std::memcpy(&size, data, sizeof(size));
+    value = string_view_t(data + sizeof(size), size);
+    return data + sizeof(size) + size;
+}
+
+template <typename T>
+const char *deferred_read(const char *data, T &value) {
+    std::memcpy(&value, data, sizeof(value));
+    return data + sizeof(value);
+}
+
+// read the arguments one by one, then format them all
+template <typename... Stored>
+struct deferred_formatter;
+
+template <>
+struct deferred_formatter<> {
+    template <typename... Decoded>
+    static void format(memory_buf_t &dest, string_view_t fmt, const char *, Decoded &...decoded) {
+#ifdef SPDLOG_USE_STD_FORMAT
+        fmt_lib::vformat_to(std::back_inserter(dest), fmt,
+                            fmt_lib::make_format_args(decoded...));
+#else
+        fmt::vformat_to(fmt::appender(dest), fmt, fmt::make_format_args(decoded...));
+#endif
+    }
+};
+
+template <typename T, typename... Rest>
+struct deferred_formatter<T, Rest...> {
+    template <typename... Decoded>
+    static void format(memory_buf_t &dest,
+                       string_view_t fmt,
+                       const char *data,
+                       Decoded &...decoded) {
+        T value;
+        data = deferred_read(data, value);
+        deferred_formatter<Rest...>::format(dest, fmt, data, decoded..., value);
+    }
+};
+
+template <typename... Stored>
+void format_deferred_args(memory_buf_t &dest, const char *data) {
+    string_view_t fmt;
+    data = deferred_read(data, fmt);
+    deferred_formatter<Stored...>::format(dest, fmt, data);
+}
+
+// capture the format string and the arguments in buf, to be formatted by format_deferred().
+// return false if some argument can't be captured: the message must be formatted right away.
+template <typename... Args>
+typename std::enable_if<deferrable<Args...>::value, bool>::type capture_deferred(
+    memory_buf_t &buf, string_view_t fmt, const Args &...args) {
+    deferred_format_fn fn = &format_deferred_args<typename deferred_arg<Args>::stored_type...>;
+    deferred_write_bytes(buf, &fn, sizeof(fn));
+    deferred_write_string(buf, fmt);
+    // a braced list is evaluated in order
+    bool captured[] = {true, deferred_arg<Args>::write(buf, args)...};
+    for (bool arg_captured : captured) {
+        if (!arg_captured) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename... Args>
+typename std::enable_if<!deferrable<Args...>::value, bool>::type capture_deferred(
+    memory_buf_t &, string_view_t, const Args &...) {
+    return false;
+}
+
+// format the payload captured by capture_deferred()
+inline void format_deferred(memory_buf_t &dest, string_view_t captured) {
+    deferred_format_fn fn;
+    std::memcpy(&fn, captured.data(), sizeof(fn));
+    fn(dest, captured.data() + sizeof(fn));
+}
+
+}  // namespace details
+}  // namespace spdlog
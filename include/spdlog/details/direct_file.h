@@ -0,0 +1,229 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef __linux__
+    #error direct_file is only supported on linux
+#endif
+
+// File written with O_DIRECT, bypassing the page cache.
+// The lines are gathered in an aligned buffer of buffer_size bytes (rounded to the alignment),
+// which is written when full. flush() writes the complete blocks of the buffer, and the partial
+// tail block padded with zeros, then truncates the file to its real size: the tail block stays in
+// the buffer and is written again by the next flush, or when the buffer is full.
+// When the file system doesn't support O_DIRECT (the open or the first write fails with EINVAL,
+// e.g. tmpfs), the file is written through the page cache instead, and the written pages are
+// dropped from the cache with posix_fadvise(POSIX_FADV_DONTNEED).
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+class direct_file {
+public:
+    // the alignment of the buffer, the file offsets and the write sizes
+    static constexpr size_t alignment = 4096;
+
+    explicit direct_file(size_t buffer_size)
+        : buffer_size_(round_up_(buffer_size == 0 ? 1 : buffer_size)) {
+        void *buffer = nullptr;
+        if (::posix_memalign(&buffer, alignment, buffer_size_) != 0) {
+            throw_spdlog_ex("direct_file: failed allocating the write buffer");
+        }
+        buffer_ = static_cast<char *>(buffer);
+    }
+
+    direct_file(const direct_file &) = delete;
+    direct_file &operator=(const direct_file &) = delete;
+
+    ~direct_file() {
+        close();
+        std::free(buffer_);
+    }
+
+    void open(const filename_t &filename, bool truncate) {
+        close();
+        filename_ = filename;
+        os::create_dir(os::dir_name(filename));
+        // read too, for the partial block at the end
+        int flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+        fd_ = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+        if (fd_ < 0 && errno == EINVAL) {
+            fd_ = ::open(filename.c_str(), flags, 0644);
+        }
+        if (fd_ < 0) {
+            throw_spdlog_ex("Failed opening file " + filename + " for writing", errno);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            int err = errno;
+            ::close(fd_);
+            fd_ = -1;
+            throw_spdlog_ex("Failed getting size of file " + filename, err);
+        }
+        // continue from the last complete block: the partial one is read back into the buffer
+        auto size = static_cast<size_t>(st.st_size);
+        block_offset_ = size / alignment * alignment;
+        used_ = size - block_offset_;
+        if (used_ > 0 && !read_tail_()) {
+            int err = errno;
+            // close the file as it is, without writing the buffer
+            used_ = 0;
+            ::close(fd_);
+            fd_ = -1;
+            throw_spdlog_ex("Failed reading the end of file " + filename, err);
+        }
+    }
+
+    void close() {
+        if (fd_ < 0) {
+            return;
+        }
+        SPDLOG_TRY { flush(); }
+        SPDLOG_CATCH_STD
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    void write(string_view_t data) {
+        const char *src = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0) {
+            size_t n = (std::min)(remaining, buffer_size_ - used_);
+            std::memcpy(buffer_ + used_, src, n);
+            used_ += n;
+            src += n;
+            remaining -= n;
+            if (used_ == buffer_size_) {
+                write_blocks_(buffer_size_);
+                block_offset_ += buffer_size_;
+                used_ = 0;
+            }
+        }
+    }
+
+    // write the buffer, with its partial tail block padded, and truncate the file to its size
+    void flush() {
+        if (used_ == 0) {
+            return;
+        }
+        auto complete = used_ / alignment * alignment;
+        auto tail = used_ - complete;
+        if (tail > 0) {
+            std::memset(buffer_ + used_, 0, alignment - tail);
+        }
+        write_blocks_(round_up_(used_));
+        if (tail > 0 && ::ftruncate(fd_, static_cast<off_t>(block_offset_ + used_)) != 0) {
+            throw_spdlog_ex("Failed truncating file " + filename_, errno);
+        }
+        // keep the tail block, to complete it
+        if (complete > 0) {
+            std::memmove(buffer_, buffer_ + complete, tail);
+            block_offset_ += complete;
+            used_ = tail;
+        }
+    }
+
+    void sync() {
+        flush();
+        if (::fdatasync(fd_) != 0) {
+            throw_spdlog_ex("Failed to fsync file " + filename_, errno);
+        }
+    }
+
+    // false if the file system doesn't support O_DIRECT
+    bool direct() const { return direct_; }
+    size_t size() const { return block_offset_ + used_; }
+    size_t buffer_size() const { return buffer_size_; }
+    const filename_t &filename() const { return filename_; }
+
+private:
+    size_t buffer_size_;
+    char *buffer_ = nullptr;
+    size_t used_ = 0;          // bytes in the buffer
+    size_t block_offset_ = 0;  // file offset of the buffer
+    int fd_ = -1;
+    bool direct_ = false;
+    filename_t filename_;
+
+    static size_t round_up_(size_t n) { return (n + alignment - 1) / alignment * alignment; }
+
+    // write the first size bytes of the buffer (a multiple of the alignment) at block_offset_
+    void write_blocks_(size_t size) {
+        size_t written = 0;
+        while (written < size) {
+            auto rv = ::pwrite(fd_, buffer_ + written, size - written,
+                               static_cast<off_t>(block_offset_ + written));
+            if (rv < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EINVAL && direct_) {
+                    // the alignment isn't enough for this file system
+                    if (!disable_direct_()) {
+                        throw_spdlog_ex("Failed disabling O_DIRECT on file " + filename_, errno);
+                    }
+                    continue;
+                }
+                throw_spdlog_ex("Failed writing to file " + filename_, errno);
+            }
+            written += static_cast<size_t>(rv);
+        }
+        if (!direct_) {
+            (void)::posix_fadvise(fd_, static_cast<off_t>(block_offset_),
+                                  static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+        }
+    }
+
+    // read the partial block at the end into the buffer. return false on failure, with errno set
+    bool read_tail_() {
+        size_t read = 0;
+        while (read < used_) {
+            auto rv = ::pread(fd_, buffer_ + read, alignment - read,
+                              static_cast<off_t>(block_offset_ + read));
+            if (rv < 0 && errno == EINVAL && direct_) {
+                if (!disable_direct_()) {
+                    return false;
+                }
+                continue;
+            }
+            if (rv < 0 && errno == EINTR) {
+                continue;
+            }
+            if (rv <= 0) {
+                if (rv == 0) {
+                    errno = EIO;  // the file shrank
+                }
+                return false;
+            }
+            read += static_cast<size_t>(rv);
+        }
+        return true;
+    }
+
+    bool disable_direct_() {
+        int flags = ::fcntl(fd_, F_GETFL);
+        if (flags < 0 || ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT) != 0) {
+            return false;
+        }
+        direct_ = false;
+        return true;
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
@@ -10,6 +10,7 @@
 #include <spdlog/common.h>
 #include <spdlog/details/os.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
@@ -28,6 +29,7 @@ SPDLOG_INLINE file_helper::~file_helper() { close(); }
 SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
     close();
     filename_ = fname;
+    reset_encoder_();
 
     auto *mode = SPDLOG_FILENAME_T("ab");
     auto *trunc_mode = SPDLOG_FILENAME_T("wb");
@@ -35,6 +37,10 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
     if (event_handlers_.before_open) {
         event_handlers_.before_open(filename_);
     }
+    // the new frame follows the last one, which may not be ended (e.g. after a crash)
+    if (encoder_ && !truncate) {
+        lz4_complete_frames(fname);
+    }
     for (int tries = 0; tries < open_tries_; ++tries) {
         // create containing folder if not exists already.
         os::create_dir(os::dir_name(fname));
@@ -52,6 +58,13 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
         if (!os::fopen_s(&fd_, fname, mode)) {
             if (event_handlers_.after_open) {
                 event_handlers_.after_open(filename_, fd_);
+                // what the handler wrote comes before the buffered writes
+                if (write_buffer_size_ > 0 || encoder_) {
+                    std::fflush(fd_);
+                }
+            }
+            if (encoder_) {
+                encoded_size_ = os::filesize(fd_);
             }
             return;
         }
@@ -71,12 +84,14 @@ SPDLOG_INLINE void file_helper::reopen(bool truncate) {
 }
 
 SPDLOG_INLINE void file_helper::flush() {
+    write_through_();
     if (std::fflush(fd_) != 0) {
         throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), errno);
     }
 }
 
 SPDLOG_INLINE void file_helper::sync() {
+    write_through_();
     if (!os::fsync(fd_)) {
         throw_spdlog_ex("Failed to fsync file " + os::filename_to_str(filename_), errno);
     }
@@ -84,6 +99,19 @@ SPDLOG_INLINE void file_helper::sync() {
 
 SPDLOG_INLINE void file_helper::close() {
     if (fd_ != nullptr) {
+        // don't throw from close(): the buffered writes are lost on failure
+        if (encoder_) {
+            if (!write_buffer_.empty()) {
+                auto block = encoder_->encode_block(
+                    string_view_t(write_buffer_.data(), write_buffer_.size()));
+                os::write_bytes(fd_, block);
+                write_buffer_.clear();
+            }
+            os::write_bytes(fd_, encoder_->end_frame());
+        } else if (!write_buffer_.empty()) {
+            os::write_bytes(fd_, string_view_t(write_buffer_.data(), write_buffer_.size()));
+            write_buffer_.clear();
+        }
         if (event_handlers_.before_close) {
             event_handlers_.before_close(filename_, fd_);
         }
@@ -98,24 +126,125 @@ SPDLOG_INLINE void file_helper::close() {
 }
 
 SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf) {
+    write(string_view_t(buf.data(), buf.size()));
+}
+
+SPDLOG_INLINE void file_helper::write(string_view_t data) {
     if (fd_ == nullptr) return;
-    size_t msg_size = buf.size();
-    auto data = buf.data();
 
-    if (!details::os::fwrite_bytes(data, msg_size, fd_)) {
+    if (encoder_) {
+        // fill the block, and compress it when full
+        auto block_size = encoder_->block_size();
+        while (data.size() > 0) {
+            auto n = (std::min)(data.size(), block_size - write_buffer_.size());
+            write_buffer_.insert(write_buffer_.end(), data.begin(), data.begin() + n);
+            data = string_view_t(data.data() + n, data.size() - n);
+            if (write_buffer_.size() == block_size) {
+                write_block_();
+            }
+        }
+        return;
+    }
+    if (write_buffer_size_ == 0) {
+        if (!details::os::fwrite_bytes(data.data(), data.size(), fd_)) {
+            throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+        }
+        return;
+    }
+    if (write_buffer_.size() + data.size() <= write_buffer_size_) {
+        write_buffer_.insert(write_buffer_.end(), data.begin(), data.end());
+        return;
+    }
+    // the buffer is full: write it, and data too if it would fill the next one
+    if (data.size() >= write_buffer_size_) {
+        write_through_(data);
+    } else {
+        write_through_();
+        write_buffer_.insert(write_buffer_.end(), data.begin(), data.end());
+    }
+}
+
+SPDLOG_INLINE void file_helper::set_write_buffer_size(size_t size) {
+    if (fd_ != nullptr) {
+        write_through_();
+        std::fflush(fd_);
+    }
+    write_buffer_size_ = size;
+    write_buffer_.clear();
+    write_buffer_.shrink_to_fit();
+    if (encoder_) {
+        // the blocks written so far stay in the current frame
+        auto end_mark = encoder_->end_frame();
+        if (fd_ != nullptr) {
+            os::write_bytes(fd_, end_mark);
+            encoded_size_ += end_mark.size();
+        }
+        encoder_.reset();
+        reset_encoder_();
+        return;
+    }
+    write_buffer_.reserve(size);
+}
+
+SPDLOG_INLINE size_t file_helper::write_buffer_size() const { return write_buffer_size_; }
+
+SPDLOG_INLINE void file_helper::set_compression(bool compress) { compress_ = compress; }
+
+SPDLOG_INLINE bool file_helper::compressed() const { return encoder_ != nullptr; }
+
+SPDLOG_INLINE void file_helper::write_through_(string_view_t data) {
+    if (encoder_) {
+        write_block_();
+        return;
+    }
+    if (fd_ == nullptr || (write_buffer_.empty() && data.size() == 0)) {
+        return;
+    }
+    bool ok = os::write_bytes(fd_, string_view_t(write_buffer_.data(), write_buffer_.size()), data);
+    write_buffer_.clear();
+    if (!ok) {
+        throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
+    }
+}
+
+SPDLOG_INLINE void file_helper::write_block_() {
+    if (fd_ == nullptr || write_buffer_.empty()) {
+        return;
+    }
+    auto block = encoder_->encode_block(string_view_t(write_buffer_.data(), write_buffer_.size()));
+    write_buffer_.clear();
+    encoded_size_ += block.size();
+    if (!os::write_bytes(fd_, block)) {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
 }
 
+SPDLOG_INLINE void file_helper::reset_encoder_() {
+    if (!compress_) {
+        encoder_.reset();
+        return;
+    }
+    if (!encoder_) {
+        encoder_ = details::make_unique<lz4_frame_encoder>(write_buffer_size_);
+    }
+    write_buffer_.reserve(encoder_->block_size());
+}
+
 SPDLOG_INLINE size_t file_helper::size() const {
     if (fd_ == nullptr) {
         throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
     }
-    return os::filesize(fd_);
+    // the buffered writes are part of the file
+    if (encoder_) {
+        return encoded_size_ + write_buffer_.size();
+    }
+    return os::filesize(fd_) + write_buffer_.size();
 }
 
 SPDLOG_INLINE const filename_t &file_helper::filename() const { return filename_; }
 
+SPDLOG_INLINE std::FILE *file_helper::handle() const { return fd_; }
+
 //
 // return file path and its extension:
 //
@@ -4,7 +4,11 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/lz4_frame.h>
+
+#include <memory>
 #include <tuple>
+#include <vector>
 
 namespace spdlog {
 namespace details {
@@ -12,6 +16,18 @@ namespace details {
 // Helper class for file sinks.
 // When failing to open a file, retry several times(5) with a delay interval(10 ms).
 // Throw spdlog_ex exception on errors.
+//
+// With a write buffer (see set_write_buffer_size()), the writes are gathered in the buffer,
+// and written directly to the file descriptor, bypassing stdio, when it's full or on flush.
+// The event handlers still get the FILE*: the buffer is written before before_close().
+//
+// With set_compression(true), the files are compressed in the lz4 frame format (see
+// lz4_frame_encoder): the buffer (the write buffer size rounded to a block size of the format,
+// 64 KiB by default) is compressed to a block when it's full or on flush, and the frame is ended
+// on close. Opening an existing file appends a new frame, after ending the last one if it wasn't
+// (see lz4_complete_frames). Only the buffered lines are lost on a crash. size() counts the bytes
+// of the file (compressed) and the buffered lines (uncompressed), without a syscall. The blocks
+// are compressed by the thread that writes. The event handlers shouldn't write to these files.
 
 class SPDLOG_API file_helper {
 public:
@@ -28,8 +44,19 @@ public:
     void sync();
     void close();
     void write(const memory_buf_t &buf);
+    void write(string_view_t data);
+    // 0 (the default) to write through stdio. flushes the current buffer.
+    void set_write_buffer_size(size_t size);
+    size_t write_buffer_size() const;
+    // compress the files in the lz4 frame format (false by default), from the next open()
+    void set_compression(bool compress);
+    // true if the file is compressed
+    bool compressed() const;
     size_t size() const;
     const filename_t &filename() const;
+    // the stdio handle of the open file, or null. e.g. to sync it outside of the writers' lock,
+    // after flush().
+    std::FILE *handle() const;
 
     //
     // return file path and its extension:
@@ -52,6 +79,17 @@ private:
     std::FILE *fd_{nullptr};
     filename_t filename_;
     file_event_handlers event_handlers_;
+    size_t write_buffer_size_ = 0;
+    std::vector<char> write_buffer_;
+    bool compress_ = false;
+    std::unique_ptr<lz4_frame_encoder> encoder_;
+    size_t encoded_size_ = 0;  // bytes of the compressed file, without a syscall
+
+    // write the buffer, then data, to the file
+    void write_through_(string_view_t data = string_view_t{});
+    // compress the buffer to a block and write it
+    void write_block_();
+    void reset_encoder_();
 };
 }  // namespace details
 }  // namespace spdlog
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstring>
 #include <iterator>
 #include <spdlog/common.h>
 #include <spdlog/fmt/fmt.h>
@@ -81,11 +82,40 @@ inline unsigned int count_digits(T n) {
 #endif
 }
 
+// "00" to "99": two digits rendered with one lookup
+inline const char *digits2(unsigned int n) {
+    static const char table[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return &table[n * 2];
+}
+
+// grow dest by n chars and return where they start
+inline char *append_uninitialized(size_t n, memory_buf_t &dest) {
+    auto size = dest.size();
+    dest.resize(size + n);
+    return &dest[size];
+}
+
+// write the Width last digits of n (zero padded) to out, two at a time
+template <unsigned int Width>
+inline void write_digits(uint32_t n, char *out) {
+    for (auto i = Width; i >= 2; i -= 2) {
+        std::memcpy(out + i - 2, digits2(n % 100), 2);
+        n /= 100;
+    }
+    if (Width % 2 != 0) {
+        out[0] = static_cast<char>('0' + n);
+    }
+}
+
 inline void pad2(int n, memory_buf_t &dest) {
     if (n >= 0 && n < 100)  // 0-99
     {
-        dest.push_back(static_cast<char>('0' + n / 10));
-        dest.push_back(static_cast<char>('0' + n % 10));
+        std::memcpy(append_uninitialized(2, dest), digits2(static_cast<unsigned int>(n)), 2);
     } else  // unlikely, but just in case, let fmt deal with it
     {
         fmt_lib::format_to(std::back_inserter(dest), SPDLOG_FMT_STRING("{:02}"), n);
@@ -105,10 +135,7 @@ template <typename T>
 inline void pad3(T n, memory_buf_t &dest) {
     static_assert(std::is_unsigned<T>::value, "pad3 must get unsigned T");
     if (n < 1000) {
-        dest.push_back(static_cast<char>(n / 100 + '0'));
-        n = n % 100;
-        dest.push_back(static_cast<char>((n / 10) + '0'));
-        dest.push_back(static_cast<char>((n % 10) + '0'));
+        write_digits<3>(static_cast<uint32_t>(n), append_uninitialized(3, dest));
     } else {
         append_int(n, dest);
     }
@@ -116,12 +143,22 @@ inline void pad3(T n, memory_buf_t &dest) {
 
 template <typename T>
 inline void pad6(T n, memory_buf_t &dest) {
-    pad_uint(n, 6, dest);
+    static_assert(std::is_unsigned<T>::value, "pad6 must get unsigned T");
+    if (n < 1000000) {
+        write_digits<6>(static_cast<uint32_t>(n), append_uninitialized(6, dest));
+    } else {
+        append_int(n, dest);
+    }
 }
 
 template <typename T>
 inline void pad9(T n, memory_buf_t &dest) {
-    pad_uint(n, 9, dest);
+    static_assert(std::is_unsigned<T>::value, "pad9 must get unsigned T");
+    if (n < 1000000000) {
+        write_digits<9>(static_cast<uint32_t>(n), append_uninitialized(9, dest));
+    } else {
+        append_int(n, dest);
+    }
 }
 
 // return fraction of a second of the given time_point.
@@ -0,0 +1,467 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef __linux__
+    #error io_uring_file is only supported on linux
+#endif
+
+// File written through io_uring, with the raw syscalls (no liburing).
+// The lines are gathered in a buffer, which is submitted for writing when full or on flush.
+// The next lines go to another buffer while the kernel writes it. At most max_in_flight buffers
+// are being written: when all of them are, write() waits for one to complete.
+// Falls back to pwrite() when io_uring is not available (old kernel, seccomp filter,
+// kernel.io_uring_disabled...).
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <linux/io_uring.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+struct io_uring_file_stats {
+    size_t in_flight = 0;         // buffers being written
+    size_t completed_writes = 0;  // buffers written
+    size_t completed_syncs = 0;
+    size_t bytes_written = 0;
+};
+
+class io_uring_file {
+public:
+    io_uring_file(size_t buffer_size, size_t max_in_flight, bool use_io_uring)
+        : buffer_size_(buffer_size == 0 ? 1 : buffer_size),
+          buffers_(max_in_flight == 0 ? 1 : max_in_flight) {
+        for (size_t i = buffers_.size(); i > 0; i--) {
+            free_.push_back(i - 1);
+        }
+        if (use_io_uring) {
+            setup_ring_();
+        }
+    }
+
+    io_uring_file(const io_uring_file &) = delete;
+    io_uring_file &operator=(const io_uring_file &) = delete;
+
+    ~io_uring_file() {
+        close();
+        teardown_ring_();
+    }
+
+    void open(const filename_t &filename, bool truncate) {
+        close();
+        filename_ = filename;
+        os::create_dir(os::dir_name(filename));
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+        fd_ = ::open(filename.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            throw_spdlog_ex("Failed opening file " + filename + " for writing", errno);
+        }
+        // the writes are at explicit offsets, so they land in order even if they complete out of
+        // order
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            int err = errno;
+            ::close(fd_);
+            fd_ = -1;
+            throw_spdlog_ex("Failed getting size of file " + filename, err);
+        }
+        file_offset_ = static_cast<uint64_t>(st.st_size);
+    }
+
+    // write the buffers still in flight, then close the file. doesn't throw.
+    void close() {
+        if (fd_ < 0) {
+            return;
+        }
+        SPDLOG_TRY {
+            submit_current_();
+            wait_all();
+        }
+        SPDLOG_CATCH_STD
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    void write(string_view_t data) {
+        const char *src = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0) {
+            auto &buf = current_buffer_();
+            size_t n = (std::min)(remaining, buffer_size_ - buf.size);
+            std::memcpy(buf.data.data() + buf.size, src, n);
+            buf.size += n;
+            src += n;
+            remaining -= n;
+            if (buf.size == buffer_size_) {
+                submit_current_();
+            }
+        }
+        reap_(false);
+    }
+
+    // submit the current buffer without waiting for it to be written
+    void flush() {
+        submit_current_();
+        reap_(false);
+    }
+
+    // submit the current buffer, and an fdatasync that runs once the writes in flight are done.
+    // waits for the previous sync if it's still in flight.
+    void sync() {
+        submit_current_();
+        if (ring_fd_ < 0) {
+            if (::fdatasync(fd_) != 0) {
+                throw_spdlog_ex("Failed to fsync file " + filename_, errno);
+            }
+            stats_.completed_syncs++;
+            return;
+        }
+        while (sync_in_flight_) {
+            reap_(true);
+        }
+        auto *sqe = next_sqe_();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->flags = IOSQE_IO_DRAIN;
+        sqe->fd = fd_;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->user_data = sync_tag;
+        sync_in_flight_ = true;
+        if (submit_sqe_() != 0) {
+            // io_uring failed: sync once the writes in flight are done
+            sync_in_flight_ = false;
+            wait_all();
+            if (::fdatasync(fd_) != 0) {
+                throw_spdlog_ex("Failed to fsync file " + filename_, errno);
+            }
+            stats_.completed_syncs++;
+        }
+    }
+
+    // wait until the submitted writes and sync are done
+    void wait_all() {
+        while (stats_.in_flight > 0 || sync_in_flight_) {
+            reap_(true);
+        }
+    }
+
+    bool uses_io_uring() const { return ring_fd_ >= 0; }
+    const io_uring_file_stats &stats() const { return stats_; }
+    const filename_t &filename() const { return filename_; }
+
+private:
+    struct buffer {
+        std::vector<char> data;
+        size_t size = 0;     // bytes in data
+        size_t written = 0;  // bytes written so far
+        uint64_t offset = 0;
+        struct iovec iov;
+    };
+
+    static const uint64_t sync_tag = ~uint64_t{0};
+    static const size_t no_buffer = ~size_t{0};
+
+    size_t buffer_size_;
+    std::vector<buffer> buffers_;
+    std::vector<size_t> free_;
+    size_t current_ = no_buffer;
+    filename_t filename_;
+    int fd_ = -1;
+    uint64_t file_offset_ = 0;
+    bool sync_in_flight_ = false;
+    size_t kernel_in_flight_ = 0;  // sqes consumed by the kernel whose completion isn't reaped
+    int write_errno_ = 0;
+    io_uring_file_stats stats_;
+
+    // the ring shared with the kernel
+    int ring_fd_ = -1;
+    void *sq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    void *cq_ring_ = MAP_FAILED;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+
+    void setup_ring_() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        // one entry per buffer, and one for the sync
+        auto entries = static_cast<unsigned>(buffers_.size() + 1);
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return;
+        }
+        ring_fd_ = fd;
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            teardown_ring_();
+            return;
+        }
+        if (single_mmap) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                teardown_ring_();
+                return;
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            teardown_ring_();
+            return;
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        auto *cq = static_cast<char *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    void teardown_ring_() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+            sqes_ = nullptr;
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        cq_ring_ = MAP_FAILED;
+        if (sq_ring_ != MAP_FAILED) {
+            ::munmap(sq_ring_, sq_ring_size_);
+            sq_ring_ = MAP_FAILED;
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+            ring_fd_ = -1;
+        }
+    }
+
+    buffer &current_buffer_() {
+        if (current_ == no_buffer) {
+            while (free_.empty()) {
+                reap_(true);
+            }
+            current_ = free_.back();
+            free_.pop_back();
+            auto &buf = buffers_[current_];
+            buf.data.resize(buffer_size_);
+            buf.size = 0;
+            buf.written = 0;
+        }
+        return buffers_[current_];
+    }
+
+    void submit_current_() {
+        if (current_ == no_buffer) {
+            return;
+        }
+        auto index = current_;
+        auto &buf = buffers_[index];
+        if (buf.size == 0) {
+            return;
+        }
+        current_ = no_buffer;
+        buf.offset = file_offset_;
+        file_offset_ += buf.size;
+        stats_.in_flight++;
+        if (ring_fd_ < 0) {
+            write_sync_(index);
+            return;
+        }
+        submit_write_(index);
+    }
+
+    // the remaining bytes of the buffer
+    void submit_write_(size_t index) {
+        auto &buf = buffers_[index];
+        buf.iov.iov_base = buf.data.data() + buf.written;
+        buf.iov.iov_len = buf.size - buf.written;
+        auto *sqe = next_sqe_();
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(&buf.iov);
+        sqe->len = 1;
+        sqe->off = buf.offset + buf.written;
+        sqe->user_data = index;
+        if (submit_sqe_() != 0) {
+            // io_uring failed: write the buffer here
+            write_sync_(index);
+        }
+    }
+
+    void write_sync_(size_t index) {
+        auto &buf = buffers_[index];
+        while (buf.written < buf.size) {
+            auto rv = ::pwrite(fd_, buf.data.data() + buf.written, buf.size - buf.written,
+                               static_cast<off_t>(buf.offset + buf.written));
+            if (rv < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                write_errno_ = errno;
+                break;
+            }
+            if (rv == 0) {
+                write_errno_ = EIO;
+                break;
+            }
+            buf.written += static_cast<size_t>(rv);
+        }
+        complete_write_(index);
+        throw_on_error_();
+    }
+
+    io_uring_sqe *next_sqe_() {
+        // at most one sqe per buffer and one sync in flight: the ring is never full
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        auto *sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        return sqe;
+    }
+
+    // publish the sqe from next_sqe_() and submit it, with any sqe left by a nested call.
+    // return 0, or the errno of io_uring_enter if the kernel didn't take the sqe, which is then
+    // taken back: no completion will come for it.
+    int submit_sqe_() {
+        __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+        for (;;) {
+            unsigned pending = *sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+            if (pending == 0) {
+                return 0;
+            }
+            auto rv = ::syscall(__NR_io_uring_enter, ring_fd_, pending, 0, 0, nullptr, 0);
+            if (rv >= 0) {
+                kernel_in_flight_ += static_cast<size_t>(rv);
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EBUSY) && kernel_in_flight_ > 0) {
+                // out of resources, or the completion queue is full: wait for a completion
+                reap_(true);
+                continue;
+            }
+            int err = errno;
+            // the sqes are taken back in reverse order, so the last one is the caller's
+            __atomic_store_n(sq_tail_, *sq_tail_ - 1, __ATOMIC_RELEASE);
+            return err;
+        }
+    }
+
+    // process the completions. if wait, wait for at least one.
+    void reap_(bool wait) {
+        if (ring_fd_ < 0) {
+            return;
+        }
+        unsigned head = *cq_head_;
+        if (wait && head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            while (::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                             nullptr, 0) < 0) {
+                if (errno != EINTR) {
+                    throw_spdlog_ex("io_uring_enter failed for file " + filename_, errno);
+                }
+            }
+        }
+        // the head is published before each completion is handled: resubmitting a short write
+        // may reap (when the completion queue is full), which must not see it again
+        for (;;) {
+            head = *cq_head_;
+            if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            const auto &cqe = cqes_[head & *cq_mask_];
+            auto user_data = cqe.user_data;
+            auto res = cqe.res;
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            kernel_in_flight_--;
+            if (user_data == sync_tag) {
+                sync_in_flight_ = false;
+                if (res < 0) {
+                    write_errno_ = -res;
+                } else {
+                    stats_.completed_syncs++;
+                }
+                continue;
+            }
+            auto index = static_cast<size_t>(user_data);
+            auto &buf = buffers_[index];
+            if (res < 0) {
+                write_errno_ = -res;
+            } else if (res == 0 && buf.written < buf.size) {
+                write_errno_ = EIO;  // no progress: the rest of the buffer would be lost
+            } else {
+                buf.written += static_cast<size_t>(res);
+                // short write: submit the rest
+                if (buf.written < buf.size) {
+                    submit_write_(index);
+                    continue;
+                }
+            }
+            complete_write_(index);
+        }
+        throw_on_error_();
+    }
+
+    void complete_write_(size_t index) {
+        auto &buf = buffers_[index];
+        stats_.in_flight--;
+        stats_.completed_writes++;
+        stats_.bytes_written += buf.written;
+        free_.push_back(index);
+    }
+
+    void throw_on_error_() {
+        if (write_errno_ != 0) {
+            int err = write_errno_;
+            write_errno_ = 0;
+            throw_spdlog_ex("Failed writing to file " + filename_, err);
+        }
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,401 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/lz4_frame.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+namespace lz4 {
+static const uint32_t frame_magic = 0x184D2204;
+static const size_t min_match = 4;
+// the last match starts at least 12 bytes before the end of the block,
+// and the last 5 bytes are literals
+static const size_t match_start_limit = 12;
+static const size_t last_literals = 5;
+static const size_t max_offset = 65535;
+static const int hash_log = 14;
+// skippable frames: 0x184D2A50 to 0x184D2A5F
+static const uint32_t skippable_magic = 0x184D2A50;
+static const uint32_t skippable_mask = 0xFFFFFFF0;
+// frame descriptor flags
+static const unsigned char flag_block_checksum = 0x10;
+static const unsigned char flag_content_size = 0x08;
+static const unsigned char flag_content_checksum = 0x04;
+static const unsigned char flag_dict_id = 0x01;
+
+SPDLOG_INLINE uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+SPDLOG_INLINE uint32_t read32_le(const unsigned char *p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+SPDLOG_INLINE unsigned char *write32_le(unsigned char *p, uint32_t v) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+    return p + 4;
+}
+
+SPDLOG_INLINE uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - hash_log);
+}
+
+// 15 in the token, then bytes of 255 and the remainder
+SPDLOG_INLINE unsigned char *write_length(unsigned char *p, size_t length) {
+    for (length -= 15; length >= 255; length -= 255) {
+        *p++ = 255;
+    }
+    *p++ = static_cast<unsigned char>(length);
+    return p;
+}
+
+SPDLOG_INLINE uint32_t rotl32(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+SPDLOG_INLINE bool read_at(std::FILE *fp, size_t pos, unsigned char *dest, size_t size) {
+#ifdef _WIN32
+    bool ok = ::_fseeki64(fp, static_cast<__int64>(pos), SEEK_SET) == 0;
+#else
+    bool ok = ::fseeko(fp, static_cast<off_t>(pos), SEEK_SET) == 0;
+#endif
+    return ok && std::fread(dest, 1, size, fp) == size;
+}
+}  // namespace lz4
+
+SPDLOG_INLINE lz4_frame_encoder::lz4_frame_encoder(size_t block_size)
+    : block_size_(min_block_size),
+      block_size_id_(4),
+      hash_table_(size_t{1} << lz4::hash_log) {
+    while (block_size_ < block_size && block_size_ < max_block_size) {
+        block_size_ *= 4;
+        block_size_id_++;
+    }
+    // frame header (7 bytes) + block size (4 bytes) + block
+    out_.resize(7 + 4 + block_size_);
+}
+
+SPDLOG_INLINE string_view_t lz4_frame_encoder::encode_block(string_view_t data) {
+    auto size = (std::min)(data.size(), block_size_);
+    auto *p = out_.data();
+    if (!frame_started_) {
+        frame_started_ = true;
+        p = lz4::write32_le(p, lz4::frame_magic);
+        auto *descriptor = p;
+        *p++ = 0x60;  // version 01, independent blocks, no checksums, no content size
+        *p++ = static_cast<unsigned char>(block_size_id_ << 4);
+        *p++ = static_cast<unsigned char>((xxh32(descriptor, 2) >> 8) & 0xFF);
+    }
+    auto *src = reinterpret_cast<const unsigned char *>(data.data());
+    auto *block = p + 4;
+    auto compressed_size = compress_block_(src, size, block);
+    if (compressed_size == 0) {
+        // the highest bit of the block size flags an uncompressed block
+        lz4::write32_le(p, static_cast<uint32_t>(size) | 0x80000000U);
+        std::memcpy(block, src, size);
+        compressed_size = size;
+    } else {
+        lz4::write32_le(p, static_cast<uint32_t>(compressed_size));
+    }
+    auto *begin = reinterpret_cast<const char *>(out_.data());
+    return string_view_t(begin, static_cast<size_t>(block - out_.data()) + compressed_size);
+}
+
+SPDLOG_INLINE string_view_t lz4_frame_encoder::end_frame() {
+    if (!frame_started_) {
+        return string_view_t{};
+    }
+    frame_started_ = false;
+    lz4::write32_le(out_.data(), 0);
+    return string_view_t(reinterpret_cast<const char *>(out_.data()), 4);
+}
+
+SPDLOG_INLINE size_t lz4_frame_encoder::compress_block_(const unsigned char *src,
+                                                        size_t size,
+                                                        unsigned char *dest) {
+    // the output is at most size bytes, else the block is stored uncompressed
+    auto *op = dest;
+    auto *op_limit = dest + size;
+    const auto *ip = src;
+    const auto *anchor = src;
+    const auto *end = src + size;
+
+    // emit literals [anchor, literal_end) then the match, if any.
+    // return false if the output would be too big.
+    auto emit = [&](const unsigned char *literal_end, size_t offset, size_t match_length) {
+        auto literal_length = static_cast<size_t>(literal_end - anchor);
+        // token + lengths + literals + offset
+        if (op + 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1 >
+            op_limit) {
+            return false;
+        }
+        auto *token = op++;
+        if (literal_length >= 15) {
+            *token = 15 << 4;
+            op = lz4::write_length(op, literal_length);
+        } else {
+            *token = static_cast<unsigned char>(literal_length << 4);
+        }
+        std::memcpy(op, anchor, literal_length);
+        op += literal_length;
+        if (match_length == 0) {
+            return true;  // last literals
+        }
+        *op++ = static_cast<unsigned char>(offset);
+        *op++ = static_cast<unsigned char>(offset >> 8);
+        match_length -= lz4::min_match;
+        if (match_length >= 15) {
+            *token = static_cast<unsigned char>(*token | 15);
+            op = lz4::write_length(op, match_length);
+        } else {
+            *token = static_cast<unsigned char>(*token | match_length);
+        }
+        return true;
+    };
+
+    if (size > lz4::match_start_limit) {
+        std::fill(hash_table_.begin(), hash_table_.end(), 0);
+        const auto *match_start_limit = end - lz4::match_start_limit;
+        const auto *match_limit = end - lz4::last_literals;
+        auto *table = hash_table_.data();
+        ip++;
+        while (ip < match_start_limit) {
+            auto h = lz4::hash(lz4::read32(ip));
+            const auto *ref = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+            if (static_cast<size_t>(ip - ref) > lz4::max_offset ||
+                lz4::read32(ref) != lz4::read32(ip)) {
+                // skip faster in data that doesn't compress
+                ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                continue;
+            }
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            auto match_length = lz4::min_match;
+            while (ip + match_length < match_limit && ip[match_length] == ref[match_length]) {
+                match_length++;
+            }
+            if (!emit(ip, static_cast<size_t>(ip - ref), match_length)) {
+                return 0;
+            }
+            ip += match_length;
+            anchor = ip;
+            if (ip < match_start_limit) {
+                table[lz4::hash(lz4::read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+    }
+    if (!emit(end, 0, 0)) {
+        return 0;
+    }
+    return static_cast<size_t>(op - dest);
+}
+
+SPDLOG_INLINE uint32_t xxh32(const void *data, size_t size, uint32_t seed) {
+    static const uint32_t prime1 = 2654435761U;
+    static const uint32_t prime2 = 2246822519U;
+    static const uint32_t prime3 = 3266489917U;
+    static const uint32_t prime4 = 668265263U;
+    static const uint32_t prime5 = 374761393U;
+
+    const auto *p = static_cast<const unsigned char *>(data);
+    const auto *end = p + size;
+    uint32_t h;
+    if (size >= 16) {
+        uint32_t v[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+        for (; p + 16 <= end; p += 16) {
+            for (int i = 0; i < 4; i++) {
+                v[i] = lz4::rotl32(v[i] + lz4::read32_le(p + 4 * i) * prime2, 13) * prime1;
+            }
+        }
+        h = lz4::rotl32(v[0], 1) + lz4::rotl32(v[1], 7) + lz4::rotl32(v[2], 12) +
+            lz4::rotl32(v[3], 18);
+    } else {
+        h = seed + prime5;
+    }
+    h += static_cast<uint32_t>(size);
+    for (; p + 4 <= end; p += 4) {
+        h = lz4::rotl32(h + lz4::read32_le(p) * prime3, 17) * prime4;
+    }
+    for (; p < end; p++) {
+        h = lz4::rotl32(h + *p * prime5, 11) * prime1;
+    }
+    h ^= h >> 15;
+    h *= prime2;
+    h ^= h >> 13;
+    h *= prime3;
+    h ^= h >> 16;
+    return h;
+}
+
+SPDLOG_INLINE void lz4_compress_file(const filename_t &src, const filename_t &dest) {
+    using details::os::filename_to_str;
+
+    std::FILE *in = nullptr;
+    if (os::fopen_s(&in, src, SPDLOG_FILENAME_T("rb"))) {
+        throw_spdlog_ex("Failed opening file " + filename_to_str(src) + " for reading", errno);
+    }
+    std::FILE *out = nullptr;
+    if (os::fopen_s(&out, dest, SPDLOG_FILENAME_T("wb"))) {
+        int err = errno;
+        std::fclose(in);
+        throw_spdlog_ex("Failed opening file " + filename_to_str(dest) + " for writing", err);
+    }
+    lz4_frame_encoder encoder(lz4_frame_encoder::max_block_size);
+    std::vector<char> buffer(encoder.block_size());
+    bool ok = true;
+    for (;;) {
+        auto n = std::fread(buffer.data(), 1, buffer.size(), in);
+        if (n > 0) {
+            auto block = encoder.encode_block(string_view_t(buffer.data(), n));
+            ok = std::fwrite(block.data(), 1, block.size(), out) == block.size();
+        }
+        if (!ok || n < buffer.size()) {
+            ok = ok && !std::ferror(in);
+            break;
+        }
+    }
+    auto end_mark = encoder.end_frame();
+    ok = ok && std::fwrite(end_mark.data(), 1, end_mark.size(), out) == end_mark.size();
+    int err = errno;
+    std::fclose(in);
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        (void)os::remove(dest);
+        throw_spdlog_ex("Failed compressing file " + filename_to_str(src), err);
+    }
+    (void)os::remove(src);
+}
+
+SPDLOG_INLINE void lz4_complete_frames(const filename_t &filename) {
+    using details::os::filename_to_str;
+
+    if (!os::path_exists(filename)) {
+        return;
+    }
+    std::FILE *fp = nullptr;
+    if (os::fopen_s(&fp, filename, SPDLOG_FILENAME_T("r+b"))) {
+        throw_spdlog_ex("Failed opening file " + filename_to_str(filename), errno);
+    }
+    auto read_failed = [&] {
+        int err = errno;
+        std::fclose(fp);
+        throw_spdlog_ex("Failed reading lz4 file " + filename_to_str(filename), err);
+    };
+    auto invalid = [&](const std::string &msg) {
+        std::fclose(fp);
+        throw_spdlog_ex(msg + " " + filename_to_str(filename));
+    };
+
+    // walk the frames and their blocks, up to the end of the file or the first partial one
+    auto size = os::filesize(fp);
+    size_t pos = 0;
+    bool in_frame = false;
+    unsigned char flags = 0;
+    unsigned char header[8];
+    while (pos < size) {
+        if (!in_frame) {
+            auto n = (std::min)(size - pos, sizeof(header));
+            if (!lz4::read_at(fp, pos, header, n)) {
+                read_failed();
+            }
+            unsigned char magic_bytes[4];
+            lz4::write32_le(magic_bytes, lz4::frame_magic);
+            if (n < 4) {
+                // a partial frame magic number
+                if (std::memcmp(header, magic_bytes, n) != 0) {
+                    invalid("Not an lz4 file:");
+                }
+                break;
+            }
+            auto magic = lz4::read32_le(header);
+            if ((magic & lz4::skippable_mask) == lz4::skippable_magic) {
+                if (n < 8 || lz4::read32_le(header + 4) > size - pos - 8) {
+                    break;
+                }
+                pos += 8 + lz4::read32_le(header + 4);
+                continue;
+            }
+            if (magic != lz4::frame_magic) {
+                invalid("Not an lz4 file:");
+            }
+            if (n < 5) {
+                break;
+            }
+            flags = header[4];
+            size_t header_size = 7 + ((flags & lz4::flag_content_size) ? 8 : 0) +
+                                 ((flags & lz4::flag_dict_id) ? 4 : 0);
+            if (header_size > size - pos) {
+                break;
+            }
+            pos += header_size;
+            in_frame = true;
+            continue;
+        }
+        if (size - pos < 4) {
+            break;
+        }
+        if (!lz4::read_at(fp, pos, header, 4)) {
+            read_failed();
+        }
+        size_t block_size = lz4::read32_le(header) & 0x7FFFFFFFU;
+        if (block_size == 0) {
+            // end mark
+            size_t end_size = 4 + ((flags & lz4::flag_content_checksum) ? 4 : 0);
+            if (end_size > size - pos) {
+                break;
+            }
+            pos += end_size;
+            in_frame = false;
+            continue;
+        }
+        size_t block_end = 4 + block_size + ((flags & lz4::flag_block_checksum) ? 4 : 0);
+        if (block_size > lz4_frame_encoder::max_block_size || block_end > size - pos) {
+            break;
+        }
+        pos += block_end;
+    }
+    if (pos == size && !in_frame) {
+        std::fclose(fp);
+        return;
+    }
+
+    // cut off the partial end, and end the frame
+    if (in_frame && (flags & lz4::flag_content_checksum)) {
+        invalid("Cannot end the last frame (with a content checksum) of lz4 file");
+    }
+    std::fflush(fp);
+    bool ok = os::truncate(fp, pos);
+    if (ok && in_frame) {
+        static const char end_mark[4] = {0, 0, 0, 0};
+        ok = std::fseek(fp, 0, SEEK_END) == 0 &&
+             std::fwrite(end_mark, 1, sizeof(end_mark), fp) == sizeof(end_mark);
+    }
+    int err = errno;
+    ok = std::fclose(fp) == 0 && ok;
+    if (!ok) {
+        throw_spdlog_ex("Failed ending the last frame of lz4 file " + filename_to_str(filename),
+                        err);
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
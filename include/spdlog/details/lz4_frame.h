@@ -0,0 +1,68 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Encoder of the lz4 frame format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md),
+// without dependency: the files can be read with "lz4 -d".
+//
+// The data is compressed in independent blocks, so the blocks already written can be decoded
+// even if the frame isn't complete (e.g. after a crash).
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API lz4_frame_encoder {
+public:
+    // block sizes of the frame format: 64 KiB, 256 KiB, 1 MiB or 4 MiB
+    static const size_t min_block_size = 64 * 1024;
+    static const size_t max_block_size = 4 * 1024 * 1024;
+
+    // block_size is rounded up to a block size of the frame format (or down to max_block_size)
+    explicit lz4_frame_encoder(size_t block_size = min_block_size);
+
+    size_t block_size() const { return block_size_; }
+
+    // compress data (at most block_size() bytes) to a block, preceded by the frame header
+    // if it's the first block of the frame. the result is valid until the next call.
+    string_view_t encode_block(string_view_t data);
+
+    // the end mark of the frame, or nothing if no block was encoded since the last end.
+    // the next block starts a new frame.
+    string_view_t end_frame();
+
+private:
+    size_t block_size_;
+    unsigned char block_size_id_;
+    bool frame_started_ = false;
+    std::vector<uint32_t> hash_table_;
+    std::vector<unsigned char> out_;
+
+    // lz4 block format. return the compressed size, or 0 if it's not smaller than size.
+    size_t compress_block_(const unsigned char *src, size_t size, unsigned char *dest);
+};
+
+// xxHash32 of data (used by the frame header checksum)
+SPDLOG_API uint32_t xxh32(const void *data, size_t size, uint32_t seed = 0);
+
+// compress the file src to dest (in one frame of 4 MiB blocks), then delete src.
+// throw spdlog_ex on failure (dest is deleted, src is kept).
+SPDLOG_API void lz4_compress_file(const filename_t &src, const filename_t &dest);
+
+// end the last frame of the lz4 file, if it wasn't (e.g. after a crash), so frames can be
+// appended: the partial block (or frame header) at the end is cut off, and the end mark written.
+// nothing is done if the file doesn't exist or its frames are complete.
+// throw spdlog_ex if it's not an lz4 file, or if its last frame has a content checksum.
+SPDLOG_API void lz4_complete_frames(const filename_t &filename);
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "lz4_frame-inl.h"
+#endif
@@ -0,0 +1,157 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifdef _WIN32
+    #error mmap_file is not supported on windows
+#endif
+
+// File written through a shared memory mapping.
+// The file is preallocated to the segment size and mapped, so a write is a memcpy into the mapping
+// (the kernel writes the dirty pages back). On close the file is truncated to the written size.
+// If the process dies before close, the file keeps its preallocated size, padded with zeros: the
+// next open appends after the last non zero byte.
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+class mmap_file {
+public:
+    mmap_file() = default;
+    mmap_file(const mmap_file &) = delete;
+    mmap_file &operator=(const mmap_file &) = delete;
+
+    ~mmap_file() { close(); }
+
+    // open the file for appending and map segment_size bytes of it (or its current size if bigger)
+    void open(const filename_t &filename, size_t segment_size, bool truncate = false) {
+        close();
+        filename_ = filename;
+        os::create_dir(os::dir_name(filename));
+        int flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+        fd_ = ::open(filename.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            throw_spdlog_ex("Failed opening file " + filename + " for writing", errno);
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            int err = errno;
+            ::close(fd_);
+            fd_ = -1;
+            throw_spdlog_ex("Failed getting size of file " + filename, err);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        map_((std::max)(segment_size, size_));
+        // the zeros preallocated by a process that died before close
+        while (size_ > 0 && data_[size_ - 1] == '\0') {
+            size_--;
+        }
+    }
+
+    // unmap the file and truncate it to the written size. doesn't throw.
+    void close() {
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            (void)::ftruncate(fd_, static_cast<off_t>(size_));
+            ::close(fd_);
+            fd_ = -1;
+        }
+        size_ = 0;
+        capacity_ = 0;
+    }
+
+    void write(string_view_t data) {
+        if (size_ + data.size() > capacity_) {
+            grow_(size_ + data.size());
+        }
+        std::memcpy(data_ + size_, data.data(), data.size());
+        size_ += data.size();
+    }
+
+    // start writing back the written pages
+    void flush() {
+        if (data_ != nullptr && size_ > 0 && ::msync(data_, size_, MS_ASYNC) != 0) {
+            throw_spdlog_ex("Failed flushing file " + filename_, errno);
+        }
+    }
+
+    // wait until the written pages are on disk
+    void sync() {
+        if (data_ != nullptr && size_ > 0 && ::msync(data_, size_, MS_SYNC) != 0) {
+            throw_spdlog_ex("Failed to fsync file " + filename_, errno);
+        }
+    }
+
+    // written bytes
+    size_t size() const { return size_; }
+    // preallocated and mapped bytes
+    size_t capacity() const { return capacity_; }
+    const filename_t &filename() const { return filename_; }
+
+private:
+    filename_t filename_;
+    int fd_ = -1;
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    void grow_(size_t capacity) {
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+        }
+        map_(capacity);
+    }
+
+    // preallocate the blocks, so writing to the mapping can't fail with SIGBUS on a full disk
+    void map_(size_t capacity) {
+        if (!allocate_(capacity)) {
+            throw_spdlog_ex("Failed allocating space for file " + filename_, errno);
+        }
+        void *data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            throw_spdlog_ex("Failed mapping file " + filename_, errno);
+        }
+        data_ = static_cast<char *>(data);
+        capacity_ = capacity;
+    }
+
+    bool allocate_(size_t capacity) {
+        auto len = static_cast<off_t>(capacity);
+#ifdef __linux__
+        if (::fallocate(fd_, 0, 0, len) == 0) {
+            return true;
+        }
+        // not supported by the file system: fall back to a sparse file
+        if (errno != EOPNOTSUPP && errno != ENOSYS) {
+            return false;
+        }
+#endif
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            return false;
+        }
+        return st.st_size >= len || ::ftruncate(fd_, len) == 0;
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
@@ -9,8 +9,14 @@
 // the queue.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// dequeue_bulk(..) - will block until the queue is not empty, then pop as many
+// items as available (up to a limit) under a single lock.
+//
+// The consumers wait according to the async_wait_policy. The condition variables are notified
+// only if some thread sleeps on them.
 
 #include <spdlog/details/circular_q.h>
+#include <spdlog/details/parking_spot.h>
 
 #include <atomic>
 #include <condition_variable>
@@ -23,42 +29,52 @@ template <typename T>
 class mpmc_blocking_queue {
 public:
     using item_type = T;
-    explicit mpmc_blocking_queue(size_t max_items)
-        : q_(max_items) {}
+    explicit mpmc_blocking_queue(size_t max_items,
+                                 async_wait_policy wait_policy = async_wait_policy::block)
+        : q_(max_items),
+          wait_policy_(wait_policy) {}
 
 #ifndef __MINGW32__
     // try to enqueue and block if no room left
     void enqueue(T &&item) {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-            q_.push_back(std::move(item));
+            wait_not_full_(lock);
+            notify = push_back_(std::move(item));
+        }
+        if (notify) {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item) {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            q_.push_back(std::move(item));
+            notify = push_back_(std::move(item));
+        }
+        if (notify) {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     void enqueue_if_have_room(T &&item) {
         bool pushed = false;
+        bool notify = false;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             if (!q_.full()) {
-                q_.push_back(std::move(item));
+                notify = push_back_(std::move(item));
                 pushed = true;
             }
         }
 
-        if (pushed) {
+        if (notify) {
             push_cv_.notify_one();
-        } else {
+        }
+        if (!pushed) {
             ++discard_counter_;
         }
     }
@@ -66,27 +82,53 @@ public:
     // dequeue with a timeout.
     // Return true, if succeeded dequeue item, false otherwise
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); })) {
+            consumers_waiting_++;
+            bool not_empty =
+                push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); });
+            consumers_waiting_--;
+            if (!not_empty) {
                 return false;
             }
-            popped_item = std::move(q_.front());
-            q_.pop_front();
+            notify = pop_front_(popped_item);
+        }
+        if (notify) {
+            pop_cv_.notify_one();
         }
-        pop_cv_.notify_one();
         return true;
     }
 
     // blocking dequeue without a timeout.
     void dequeue(T &popped_item) {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            push_cv_.wait(lock, [this] { return !this->q_.empty(); });
-            popped_item = std::move(q_.front());
-            q_.pop_front();
+            wait_not_empty_(lock);
+            notify = pop_front_(popped_item);
+        }
+        if (notify) {
+            pop_cv_.notify_one();
         }
-        pop_cv_.notify_one();
+    }
+
+    // blocking dequeue of up to max_count items at once.
+    // Return the number of items moved to popped_items (at least one).
+    size_t dequeue_bulk(T *popped_items, size_t max_count) {
+        size_t count = 0;
+        bool notify = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            wait_not_empty_(lock);
+            while (count < max_count && !q_.empty()) {
+                notify = pop_front_(popped_items[count++]);
+            }
+        }
+        if (notify) {
+            pop_cv_.notify_all();
+        }
+        return count;
     }
 
 #else
@@ -96,28 +138,26 @@ public:
     // try to enqueue and block if no room left
     void enqueue(T &&item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        wait_not_full_(lock);
+        if (push_back_(std::move(item))) {
+            push_cv_.notify_one();
+        }
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        if (push_back_(std::move(item))) {
+            push_cv_.notify_one();
+        }
     }
 
     void enqueue_if_have_room(T &&item) {
-        bool pushed = false;
         std::unique_lock<std::mutex> lock(queue_mutex_);
         if (!q_.full()) {
-            q_.push_back(std::move(item));
-            pushed = true;
-        }
-
-        if (pushed) {
-            push_cv_.notify_one();
+            if (push_back_(std::move(item))) {
+                push_cv_.notify_one();
+            }
         } else {
             ++discard_counter_;
         }
@@ -127,22 +167,42 @@ public:
     // Return true, if succeeded dequeue item, false otherwise
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); })) {
+        consumers_waiting_++;
+        bool not_empty =
+            push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); });
+        consumers_waiting_--;
+        if (!not_empty) {
             return false;
         }
-        popped_item = std::move(q_.front());
-        q_.pop_front();
-        pop_cv_.notify_one();
+        if (pop_front_(popped_item)) {
+            pop_cv_.notify_one();
+        }
         return true;
     }
 
     // blocking dequeue without a timeout.
     void dequeue(T &popped_item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        push_cv_.wait(lock, [this] { return !this->q_.empty(); });
-        popped_item = std::move(q_.front());
-        q_.pop_front();
-        pop_cv_.notify_one();
+        wait_not_empty_(lock);
+        if (pop_front_(popped_item)) {
+            pop_cv_.notify_one();
+        }
+    }
+
+    // blocking dequeue of up to max_count items at once.
+    // Return the number of items moved to popped_items (at least one).
+    size_t dequeue_bulk(T *popped_items, size_t max_count) {
+        size_t count = 0;
+        bool notify = false;
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        wait_not_empty_(lock);
+        while (count < max_count && !q_.empty()) {
+            notify = pop_front_(popped_items[count++]);
+        }
+        if (notify) {
+            pop_cv_.notify_all();
+        }
+        return count;
     }
 
 #endif
@@ -167,11 +227,59 @@ public:
     void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
 
 private:
+    // push the item. return true if a consumer is sleeping and must be notified.
+    bool push_back_(T &&item) {
+        q_.push_back(std::move(item));
+        has_items_.store(true, std::memory_order_relaxed);
+        return consumers_waiting_ > 0;
+    }
+
+    // pop the oldest item. return true if a producer is sleeping and must be notified.
+    bool pop_front_(T &popped_item) {
+        popped_item = std::move(q_.front());
+        q_.pop_front();
+        has_items_.store(!q_.empty(), std::memory_order_relaxed);
+        return producers_waiting_ > 0;
+    }
+
+    // wait until the queue is not empty. spin without the lock first, as allowed by the policy.
+    // a spinning consumer is not counted as waiting, so producers don't notify it.
+    void wait_not_empty_(std::unique_lock<std::mutex> &lock) {
+        bool spun = false;
+        while (q_.empty()) {
+            if (wait_policy_ == async_wait_policy::busy_spin ||
+                (wait_policy_ == async_wait_policy::spin_yield_park && !spun)) {
+                lock.unlock();
+                parking_spot::spin(
+                    [this] { return this->has_items_.load(std::memory_order_relaxed); },
+                    wait_policy_);
+                lock.lock();
+                spun = true;
+                continue;
+            }
+            consumers_waiting_++;
+            push_cv_.wait(lock, [this] { return !this->q_.empty(); });
+            consumers_waiting_--;
+        }
+    }
+
+    void wait_not_full_(std::unique_lock<std::mutex> &lock) {
+        producers_waiting_++;
+        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        producers_waiting_--;
+    }
+
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
     spdlog::details::circular_q<T> q_;
     std::atomic<size_t> discard_counter_{0};
+    const async_wait_policy wait_policy_;
+    // threads sleeping on push_cv_ / pop_cv_ (protected by queue_mutex_)
+    size_t consumers_waiting_ = 0;
+    size_t producers_waiting_ = 0;
+    // hint for the spinning consumers, read without the lock
+    std::atomic<bool> has_items_{false};
 };
 }  // namespace details
 }  // namespace spdlog
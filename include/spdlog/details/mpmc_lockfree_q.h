@@ -0,0 +1,243 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer bounded lock-free queue.
+// Based on Dmitry Vyukov's bounded MPMC queue: each slot carries a sequence number, so producers
+// and consumers only compete on the (cache line padded) tail and head counters.
+// Threads that have nothing to do are parked on a parking_spot: a producer takes a lock only if a
+// consumer is parked, and vice versa. Consumers spin before parking as told by the wait policy.
+//
+// Same interface as mpmc_blocking_queue:
+// enqueue(..) - will block until room found to put the new message.
+// enqueue_nowait(..) - will overrun the oldest message in the queue if no room left.
+// enqueue_if_have_room(..) - will discard the new message if no room left.
+// dequeue_for(..) - will block until the queue is not empty or timeout have passed.
+// dequeue_bulk(..) - will block until the queue is not empty, then pop up to a limit of items.
+//
+// Note: the capacity is rounded up to the next power of two.
+
+#include <spdlog/common.h>
+#include <spdlog/details/parking_spot.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+template <typename T>
+class mpmc_lockfree_queue {
+public:
+    using item_type = T;
+
+    explicit mpmc_lockfree_queue(size_t max_items,
+                                 async_wait_policy wait_policy = async_wait_policy::block)
+        : capacity_(round_up_pow2_(max_items)),
+          mask_(capacity_ - 1),
+          buffer_(new cell[capacity_]),
+          wait_policy_(wait_policy) {
+        for (size_t i = 0; i < capacity_; i++) {
+            buffer_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        if (max_items == 0) {
+            capacity_ = 0;  // disabled queue. every enqueue is counted as overrun/discard.
+        }
+    }
+
+    mpmc_lockfree_queue(const mpmc_lockfree_queue &) = delete;
+    mpmc_lockfree_queue &operator=(const mpmc_lockfree_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item) {
+        if (!try_enqueue(item)) {
+            producers_.spin_wait([this, &item] { return this->try_enqueue(item); });
+        }
+        consumers_.notify_one();
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    void enqueue_nowait(T &&item) {
+        force_enqueue(item);
+        consumers_.notify_one();
+    }
+
+    void enqueue_if_have_room(T &&item) {
+        if (try_enqueue_or_discard(item)) {
+            consumers_.notify_one();
+        }
+    }
+
+    // dequeue with a timeout.
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
+        if (!try_dequeue(popped_item) &&
+            !consumers_.wait_for([this, &popped_item] { return this->try_dequeue(popped_item); },
+                                 wait_duration)) {
+            return false;
+        }
+        producers_.notify_one();
+        return true;
+    }
+
+    // blocking dequeue without a timeout.
+    void dequeue(T &popped_item) {
+        if (!try_dequeue(popped_item)) {
+            consumers_.wait([this, &popped_item] { return this->try_dequeue(popped_item); },
+                            wait_policy_);
+        }
+        producers_.notify_one();
+    }
+
+    // blocking dequeue of up to max_count items at once.
+    // Return the number of items moved to popped_items (at least one).
+    size_t dequeue_bulk(T *popped_items, size_t max_count) {
+        if (!try_dequeue(popped_items[0])) {
+            consumers_.wait([this, popped_items] { return this->try_dequeue(popped_items[0]); },
+                            wait_policy_);
+        }
+        size_t count = 1;
+        while (count < max_count && try_dequeue(popped_items[count])) {
+            count++;
+        }
+        producers_.notify_all();
+        return count;
+    }
+
+    // The functions below never block nor wake up parked threads.
+    // They are meant for callers that do their own parking (see thread_pool).
+
+    // push, or count the item as discarded if no room left.
+    bool try_enqueue_or_discard(T &item) {
+        if (try_enqueue(item)) {
+            return true;
+        }
+        discard_counter_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // push, overrunning the oldest item if no room left.
+    void force_enqueue(T &item) {
+        while (!try_enqueue(item)) {
+            if (capacity_ == 0) {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            T oldest;
+            if (try_dequeue(oldest)) {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();  // some consumer is in the middle of a pop
+            }
+        }
+    }
+
+    // non blocking push. the item is moved from only if there was room for it.
+    bool try_enqueue(T &item) {
+        if (capacity_ == 0) {
+            return false;
+        }
+        cell *c;
+        size_t pos = tail_.value.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &buffer_[pos & mask_];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail_.value.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = std::move(item);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // non blocking pop.
+    bool try_dequeue(T &popped_item) {
+        cell *c;
+        size_t pos = head_.value.load(std::memory_order_relaxed);
+        for (;;) {
+            c = &buffer_[pos & mask_];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = head_.value.load(std::memory_order_relaxed);
+            }
+        }
+        popped_item = std::move(c->data);
+        c->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t overrun_counter() const { return overrun_counter_.load(std::memory_order_relaxed); }
+
+    size_t discard_counter() const { return discard_counter_.load(std::memory_order_relaxed); }
+
+    size_t size() const {
+        size_t head = head_.value.load(std::memory_order_acquire);
+        size_t tail = tail_.value.load(std::memory_order_acquire);
+        size_t n = tail - head;
+        return n < capacity_ ? n : capacity_;
+    }
+
+    // return the actual capacity (max_items rounded up to power of 2)
+    size_t capacity() const { return capacity_; }
+
+    void reset_overrun_counter() { overrun_counter_.store(0, std::memory_order_relaxed); }
+
+    void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
+
+private:
+    static SPDLOG_CONSTEXPR size_t cache_line_size = 64;
+
+    struct cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    // keep each counter in its own cache line to prevent false sharing
+    struct padded_counter {
+        char padding_before[cache_line_size];
+        std::atomic<size_t> value{0};
+        char padding_after[cache_line_size - sizeof(std::atomic<size_t>)];
+    };
+
+    static size_t round_up_pow2_(size_t n) {
+        size_t rv = 1;
+        while (rv < n) {
+            rv <<= 1;
+        }
+        return rv;
+    }
+
+    size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<cell[]> buffer_;
+    const async_wait_policy wait_policy_;  // how consumers wait for items
+
+    padded_counter tail_;  // next position to write (producers)
+    padded_counter head_;  // next position to read (consumers)
+
+    std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> discard_counter_{0};
+    parking_spot consumers_;  // consumers waiting for items
+    parking_spot producers_;  // producers waiting for room
+};
+}  // namespace details
+}  // namespace spdlog
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
@@ -20,6 +21,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <thread>
+#include <vector>
 
 #ifdef _WIN32
     #include <spdlog/details/windows_include.h>
@@ -40,7 +42,9 @@
 
 #else  // unix
 
+    #include <dirent.h>  // for opendir
     #include <fcntl.h>
+    #include <sys/uio.h>  // for writev
     #include <unistd.h>
 
     #ifdef __linux__
@@ -85,10 +89,117 @@ SPDLOG_INLINE spdlog::log_clock::time_point now() SPDLOG_NOEXCEPT {
     return log_clock::now();
 #endif
 }
+
+#if defined(SPDLOG_FAST_LOCALTIME) && !defined(_WIN32) && !defined(SPDLOG_NO_TLS) && \
+    !(defined(sun) || defined(__sun) || defined(_AIX) ||                           \
+      (defined(__NEWLIB__) && !defined(__TM_GMTOFF)) ||                            \
+      (!defined(_BSD_SOURCE) && !defined(_GNU_SOURCE)))
+    #define SPDLOG_CACHED_LOCAL_ZONE_
+
+// The local time computed from the utc offset in force, without localtime_r() and the time zone
+// lock it takes (SPDLOG_FAST_LOCALTIME). Each thread keeps the offset of the zone (with its dst
+// flag and name) over an interval: from the previous transition of the zone (e.g. the start or
+// the end of dst) or one day before the time it was found at, up to the next transition or one
+// day after. So the earlier times of other threads (e.g. seen by an async worker) are in it too.
+// localtime_r() is called again only out of the interval, and bisects the transitions within the
+// day. So a change of the time zone of the process (TZ) is seen within a day.
+struct local_zone_interval {
+    std::time_t begin = 0;
+    std::time_t end = 0;  // excluded
+    long offset = 0;      // seconds east of utc
+    int isdst = 0;
+    decltype(std::tm::tm_zone) zone = nullptr;
+
+    bool contains(std::time_t time_tt) const { return time_tt >= begin && time_tt < end; }
+
+    void find(std::time_t time_tt) {
+        const std::time_t day = 24 * 60 * 60;
+        std::tm tm;
+        ::localtime_r(&time_tt, &tm);
+        offset = tm.tm_gmtoff;
+        isdst = tm.tm_isdst;
+        zone = tm.tm_zone;
+        begin = last_in_zone(tm, time_tt, time_tt - day);
+        end = last_in_zone(tm, time_tt, time_tt + day) + 1;
+    }
+
+    // the last time in the zone of tm going from in (in the zone) toward out
+    static std::time_t last_in_zone(const std::tm &tm, std::time_t in, std::time_t out) {
+        std::tm probe;
+        ::localtime_r(&out, &probe);
+        if (same_zone(tm, probe)) {
+            return out;
+        }
+        // the transition is between in and out
+        while (in - out > 1 || out - in > 1) {
+            auto mid = in + (out - in) / 2;
+            ::localtime_r(&mid, &probe);
+            if (same_zone(tm, probe)) {
+                in = mid;
+            } else {
+                out = mid;
+            }
+        }
+        return in;
+    }
+
+    std::tm local_tm(std::time_t time_tt) const {
+        const long long day = 24 * 60 * 60;
+        long long local = static_cast<long long>(time_tt) + offset;
+        long long days = local / day;
+        long long secs = local % day;
+        if (secs < 0) {
+            secs += day;
+            days--;
+        }
+        std::tm tm{};
+        tm.tm_hour = static_cast<int>(secs / 3600);
+        tm.tm_min = static_cast<int>(secs / 60 % 60);
+        tm.tm_sec = static_cast<int>(secs % 60);
+        tm.tm_wday = static_cast<int>((days % 7 + 11) % 7);  // 1970-01-01 was a thursday
+
+        // civil date from the days since epoch, see
+        // http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+        long long z = days + 719468;
+        long long era = (z >= 0 ? z : z - 146096) / 146097;
+        long long doe = z - era * 146097;                                    // [0, 146096]
+        long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+        long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);              // from march 1st
+        long long mp = (5 * doy + 2) / 153;                                  // [0, 11]
+        long long mday = doy - (153 * mp + 2) / 5 + 1;
+        long long month = mp < 10 ? mp + 3 : mp - 9;  // [1, 12]
+        long long year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        static const int days_before_month[] = {0,   31,  59,  90,  120, 151,
+                                                181, 212, 243, 273, 304, 334};
+
+        tm.tm_year = static_cast<int>(year - 1900);
+        tm.tm_mon = static_cast<int>(month - 1);
+        tm.tm_mday = static_cast<int>(mday);
+        tm.tm_yday = days_before_month[month - 1] + static_cast<int>(mday) - 1 +
+                     (leap && month > 2 ? 1 : 0);
+        tm.tm_isdst = isdst;
+        tm.tm_gmtoff = offset;
+        tm.tm_zone = zone;
+        return tm;
+    }
+
+    static bool same_zone(const std::tm &a, const std::tm &b) {
+        return a.tm_gmtoff == b.tm_gmtoff && a.tm_isdst == b.tm_isdst;
+    }
+};
+#endif
+
 SPDLOG_INLINE std::tm localtime(const std::time_t &time_tt) SPDLOG_NOEXCEPT {
 #ifdef _WIN32
     std::tm tm;
     ::localtime_s(&tm, &time_tt);
+#elif defined(SPDLOG_CACHED_LOCAL_ZONE_)
+    static thread_local local_zone_interval interval;
+    if (!interval.contains(time_tt)) {
+        interval.find(time_tt);
+    }
+    std::tm tm = interval.local_tm(time_tt);
 #else
     std::tm tm;
     ::localtime_r(&time_tt, &tm);
@@ -563,6 +674,51 @@ SPDLOG_INLINE filename_t dir_name(const filename_t &path) {
     return pos != filename_t::npos ? path.substr(0, pos) : filename_t{};
 }
 
+SPDLOG_INLINE std::vector<filename_t> dir_entries(const filename_t &path) {
+    std::vector<filename_t> entries;
+    auto is_dot = [](const filename_t &name) {
+        return name == SPDLOG_FILENAME_T(".") || name == SPDLOG_FILENAME_T("..");
+    };
+#ifdef _WIN32
+    filename_t pattern = path.empty() ? filename_t{SPDLOG_FILENAME_T("*")}
+                                      : path + filename_t{SPDLOG_FILENAME_T("\\*")};
+    #ifdef SPDLOG_WCHAR_FILENAMES
+    WIN32_FIND_DATAW data;
+    HANDLE find = ::FindFirstFileW(pattern.c_str(), &data);
+    #else
+    WIN32_FIND_DATAA data;
+    HANDLE find = ::FindFirstFileA(pattern.c_str(), &data);
+    #endif
+    if (find == INVALID_HANDLE_VALUE) {
+        return entries;
+    }
+    do {
+        filename_t name = data.cFileName;
+        if (!is_dot(name)) {
+            entries.push_back(std::move(name));
+        }
+    #ifdef SPDLOG_WCHAR_FILENAMES
+    } while (::FindNextFileW(find, &data));
+    #else
+    } while (::FindNextFileA(find, &data));
+    #endif
+    ::FindClose(find);
+#else
+    DIR *dir = ::opendir(path.empty() ? "." : path.c_str());
+    if (dir == nullptr) {
+        return entries;
+    }
+    while (auto *entry = ::readdir(dir)) {
+        filename_t name = entry->d_name;
+        if (!is_dot(name)) {
+            entries.push_back(std::move(name));
+        }
+    }
+    ::closedir(dir);
+#endif
+    return entries;
+}
+
 std::string SPDLOG_INLINE getenv(const char *field) {
 #if defined(_MSC_VER)
     #if defined(__cplusplus_winrt)
@@ -589,6 +745,24 @@ SPDLOG_INLINE bool fsync(FILE *fp) {
 #endif
 }
 
+// Do fdatasync by FILE handlerpointer
+// Return true on success
+SPDLOG_INLINE bool fdatasync(FILE *fp) {
+#if defined(_WIN32) || defined(__APPLE__)
+    return fsync(fp);
+#else
+    return ::fdatasync(fileno(fp)) == 0;
+#endif
+}
+
+SPDLOG_INLINE bool truncate(FILE *fp, size_t size) {
+#ifdef _WIN32
+    return ::_chsize_s(::_fileno(fp), static_cast<__int64>(size)) == 0;
+#else
+    return ::ftruncate(fileno(fp), static_cast<off_t>(size)) == 0;
+#endif
+}
+
 // Do non-locking fwrite if possible by the os or use the regular locking fwrite
 // Return true on success.
 SPDLOG_INLINE bool fwrite_bytes(const void *ptr, const size_t n_bytes, FILE *fp) {
@@ -601,6 +775,62 @@ SPDLOG_INLINE bool fwrite_bytes(const void *ptr, const size_t n_bytes, FILE *fp)
     #endif
 }
 
+SPDLOG_INLINE bool write_bytes(FILE *fp, string_view_t data1, string_view_t data2) {
+#ifdef _WIN32
+    int fd = ::_fileno(fp);
+    for (string_view_t data : {data1, data2}) {
+        const char *begin = data.data();
+        size_t remaining = data.size();
+        while (remaining > 0) {
+            auto chunk = static_cast<unsigned int>((std::min)(remaining, size_t{1} << 30));
+            int written = ::_write(fd, begin, chunk);
+            if (written < 0) {
+                return false;
+            }
+            begin += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+    return true;
+#else
+    // OpenBSD and AIX doesn't compile with :: before the fileno(..)
+    #if defined(__OpenBSD__) || defined(_AIX)
+    int fd = fileno(fp);
+    #else
+    int fd = ::fileno(fp);
+    #endif
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<char *>(data1.data());
+    iov[0].iov_len = data1.size();
+    iov[1].iov_base = const_cast<char *>(data2.data());
+    iov[1].iov_len = data2.size();
+    int first = 0;
+    while (first < 2) {
+        if (iov[first].iov_len == 0) {
+            ++first;
+            continue;
+        }
+        auto written = ::writev(fd, iov + first, 2 - first);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        // skip what was written, the rest is written by the next call
+        auto n = static_cast<size_t>(written);
+        for (; first < 2 && n >= iov[first].iov_len; ++first) {
+            n -= iov[first].iov_len;
+        }
+        if (first < 2) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + n;
+            iov[first].iov_len -= n;
+        }
+    }
+    return true;
+#endif
+}
+
 }  // namespace os
 }  // namespace details
 }  // namespace spdlog
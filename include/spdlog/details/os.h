@@ -4,6 +4,7 @@
 #pragma once
 
 #include <ctime>  // std::time_t
+#include <vector>
 #include <spdlog/common.h>
 
 namespace spdlog {
@@ -106,6 +107,10 @@ SPDLOG_API filename_t dir_name(const filename_t &path);
 // Return true if succeeded or if this dir already exists.
 SPDLOG_API bool create_dir(const filename_t &path);
 
+// Return the names of the entries of the given dir (the current dir if empty),
+// without "." and "..". Return an empty vector if the dir can't be read.
+SPDLOG_API std::vector<filename_t> dir_entries(const filename_t &path);
+
 // non thread safe, cross platform getenv/getenv_s
 // return empty string if field not found
 SPDLOG_API std::string getenv(const char *field);
@@ -114,10 +119,25 @@ SPDLOG_API std::string getenv(const char *field);
 // Return true on success.
 SPDLOG_API bool fsync(FILE *fp);
 
+// Do fdatasync by FILE objectpointer (the file data and size, without the other metadata).
+// Same as fsync where not available.
+// Return true on success.
+SPDLOG_API bool fdatasync(FILE *fp);
+
+// Truncate (or extend with zeros) the file of fp to size bytes. The stdio buffer of fp should be
+// flushed before.
+// Return true on success.
+SPDLOG_API bool truncate(FILE *fp, size_t size);
+
 // Do non-locking fwrite if possible by the os or use the regular locking fwrite
 // Return true on success.
 SPDLOG_API bool fwrite_bytes(const void *ptr, const size_t n_bytes, FILE *fp);
 
+// Write data1 then data2 to the file descriptor of fp, bypassing the stdio buffer of fp (which
+// should be flushed before). Uses a single writev() when possible.
+// Return true on success.
+SPDLOG_API bool write_bytes(FILE *fp, string_view_t data1, string_view_t data2 = string_view_t{});
+
 }  // namespace os
 }  // namespace details
 }  // namespace spdlog
@@ -0,0 +1,133 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Lets threads sleep until a condition that is updated without any lock becomes true.
+// The notifier pays for the mutex and the condition variable only if some thread is parked:
+//
+//   consumer: spot.wait([&] { return q.try_dequeue(item); });
+//   producer: q.try_enqueue(item); spot.notify_one();
+//
+// The waiters counter is published before the condition is checked for the last time, so either
+// the waiter sees the update, or the notifier sees the waiter and wakes it up.
+// A waiter that only spins (async_wait_policy::busy_spin) costs the notifier nothing.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+class parking_spot {
+public:
+    parking_spot() = default;
+    parking_spot(const parking_spot &) = delete;
+    parking_spot &operator=(const parking_spot &) = delete;
+
+    // block until pred() returns true. pred is called with the internal lock held.
+    template <typename Pred>
+    void wait(Pred pred) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv_.wait(lock, pred);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // retry pred() a few times, yielding the cpu, before blocking.
+    // cheaper for the notifier when the condition is about to become true.
+    template <typename Pred>
+    void spin_wait(Pred pred) {
+        wait(pred, async_wait_policy::spin_yield_park);
+    }
+
+    // block until pred() returns true, spinning first as allowed by the policy
+    template <typename Pred>
+    void wait(Pred pred, async_wait_policy policy) {
+        if (!spin(pred, policy)) {
+            wait(pred);
+        }
+    }
+
+    // retry pred() without blocking, as allowed by the policy (forever if busy_spin).
+    // return false if pred() is still false and the caller should block.
+    template <typename Pred>
+    static bool spin(Pred pred, async_wait_policy policy) {
+        if (policy == async_wait_policy::block) {
+            return false;
+        }
+        for (int i = 0; policy == async_wait_policy::busy_spin || i < spin_count; i++) {
+            if (pred()) {
+                return true;
+            }
+            if (policy == async_wait_policy::spin_yield_park && i >= spin_count / 2) {
+                std::this_thread::yield();
+            } else {
+                cpu_relax();
+            }
+        }
+        return false;
+    }
+
+    // block until pred() returns true or the timeout expired.
+    // return the last result of pred().
+    template <typename Pred>
+    bool wait_for(Pred pred, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool rv = cv_.wait_for(lock, timeout, pred);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return rv;
+    }
+
+    // call after the condition was updated.
+    // notify while holding the lock (mingw deadlocks otherwise, see mpmc_blocking_q.h)
+    void notify_one() {
+        if (has_waiters()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_one();
+        }
+    }
+
+    void notify_all() {
+        if (has_waiters()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    bool has_waiters() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return waiters_.load(std::memory_order_relaxed) > 0;
+    }
+
+private:
+    // number of attempts in spin() before blocking
+    static const int spin_count = 64;
+
+    // hint the cpu that this is a spin loop
+    static void cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+        _mm_pause();
+#endif
+    }
+
+    std::atomic<size_t> waiters_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+}  // namespace details
+}  // namespace spdlog
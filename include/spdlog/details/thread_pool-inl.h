@@ -7,36 +7,102 @@
     #include <spdlog/details/thread_pool.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <spdlog/common.h>
 
 namespace spdlog {
 namespace details {
 
+// staging queues of the calling thread, one per thread pool it logged to
+// (async_queue_type::per_thread)
+struct thread_staging_queues {
+    std::vector<std::shared_ptr<staging_queue>> queues;
+
+    ~thread_staging_queues() {
+        for (auto &q : queues) {
+            q->producer_exited.store(true, std::memory_order_release);
+        }
+    }
+};
+
+SPDLOG_INLINE size_t next_thread_pool_id() {
+    static std::atomic<size_t> last_id{0};
+    return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// the workers allocate either msgs or records, according to the queue type
+SPDLOG_INLINE async_msg_batch::async_msg_batch(size_t max_size) { run.reserve(max_size); }
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
                                        std::function<void()> on_thread_start,
-                                       std::function<void()> on_thread_stop)
-    : q_(q_max_items) {
+                                       std::function<void()> on_thread_stop,
+                                       const thread_pool_options &options)
+    : queue_type_(options.queue_type),
+      id_(next_thread_pool_id()),
+      q_max_items_(q_max_items),
+      max_batch_size_(options.max_batch_size > 0 ? options.max_batch_size : 1),
+      wait_policy_(options.wait_policy) {
     if (threads_n == 0 || threads_n > 1000) {
         throw_spdlog_ex(
             "spdlog::thread_pool(): invalid threads_n param (valid "
             "range is 1-1000)");
     }
+#ifdef SPDLOG_NO_TLS
+    if (queue_type_ == async_queue_type::per_thread) {
+        queue_type_ = async_queue_type::lock_free;
+    }
+#endif
+    if (queue_type_ == async_queue_type::per_thread) {
+        for (size_t i = 0; i < threads_n; i++) {
+            staging_workers_.emplace_back(new staging_worker());
+        }
+    } else {
+        shards_.resize(options.sharded ? threads_n : 1);
+        for (auto &target : shards_) {
+            if (queue_type_ == async_queue_type::lock_free) {
+                target.lockfree_q =
+                    details::make_unique<lockfree_q_type>(q_max_items, wait_policy_);
+            } else if (queue_type_ == async_queue_type::arena) {
+                target.arena_q = details::make_unique<arena_q_type>(
+                    q_max_items * arena_bytes_per_item, wait_policy_);
+            } else {
+                target.q = details::make_unique<q_type>(q_max_items, wait_policy_);
+            }
+        }
+    }
+    logger_handles_ = options.logger_handles && staging_workers_.empty();
     for (size_t i = 0; i < threads_n; i++) {
-        threads_.emplace_back([this, on_thread_start, on_thread_stop] {
+        threads_.emplace_back([this, i, on_thread_start, on_thread_stop] {
             on_thread_start();
-            this->thread_pool::worker_loop_();
+            this->thread_pool::worker_loop_(i);
             on_thread_stop();
         });
     }
 }
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
+                                       size_t threads_n,
+                                       std::function<void()> on_thread_start,
+                                       std::function<void()> on_thread_stop)
+    : thread_pool(q_max_items,
+                  threads_n,
+                  std::move(on_thread_start),
+                  std::move(on_thread_stop),
+                  thread_pool_options{}) {}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
                                        std::function<void()> on_thread_start)
     : thread_pool(q_max_items, threads_n, on_thread_start, [] {}) {}
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
+                                       size_t threads_n,
+                                       const thread_pool_options &options)
+    : thread_pool(
+          q_max_items, threads_n, [] {}, [] {}, options) {}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
     : thread_pool(
           q_max_items, threads_n, [] {}, [] {}) {}
@@ -44,70 +110,351 @@ SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
 // message all threads to terminate gracefully join them
 SPDLOG_INLINE thread_pool::~thread_pool() {
     SPDLOG_TRY {
-        for (size_t i = 0; i < threads_.size(); i++) {
-            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+        if (staging_workers_.empty()) {
+            for (size_t i = 0; i < threads_.size(); i++) {
+                post_to_shard_(shards_[i % shards_.size()], async_msg(async_msg_type::terminate),
+                               async_overflow_policy::block);
+            }
+        } else {
+            // staging workers exit after draining all their queues
+            staging_stop_.store(true, std::memory_order_release);
+            for (auto &worker : staging_workers_) {
+                worker->work.notify_all();
+            }
         }
 
         for (auto &t : threads_) {
             t.join();
         }
+
+        // let the producer threads release their (now unused) staging queues
+        for_each_staging_queue_([](staging_queue &sq) {
+            sq.pool_closed.store(true, std::memory_order_relaxed);
+        });
     }
     SPDLOG_CATCH_STD
 }
 
 void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr,
                                          const details::log_msg &msg,
-                                         async_overflow_policy overflow_policy) {
-    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
+                                         async_overflow_policy overflow_policy,
+                                         async_msg_type msg_type) {
+    if (queue_type_ == async_queue_type::arena) {
+        // copy the payload straight to the arena
+        auto &target = shards_[shards_.size() > 1 ? worker_ptr->shard_ : 0];
+        post_record_(target, msg_type, std::move(worker_ptr), 0, msg, overflow_policy);
+        return;
+    }
+    async_msg async_m(std::move(worker_ptr), msg_type, msg);
     post_async_msg_(std::move(async_m), overflow_policy);
 }
 
 void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr,
                                            async_overflow_policy overflow_policy) {
-    post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
+    async_msg flush_msg(std::move(worker_ptr), async_msg_type::flush);
+    // staging workers merge messages by time
+    flush_msg.time = log_clock::now();
+    post_async_msg_(std::move(flush_msg), overflow_policy);
 }
 
-size_t SPDLOG_INLINE thread_pool::overrun_counter() { return q_.overrun_counter(); }
+void SPDLOG_INLINE thread_pool::post_log(size_t logger_handle,
+                                         const details::log_msg &msg,
+                                         async_overflow_policy overflow_policy,
+                                         async_msg_type msg_type) {
+    if (queue_type_ == async_queue_type::arena) {
+        auto &target = shards_[shards_.size() > 1 ? registered_logger_(logger_handle)->shard_ : 0];
+        post_record_(target, msg_type, nullptr, logger_handle, msg, overflow_policy);
+        return;
+    }
+    async_msg async_m(logger_handle, msg_type, msg);
+    post_async_msg_(std::move(async_m), overflow_policy);
+}
 
-void SPDLOG_INLINE thread_pool::reset_overrun_counter() { q_.reset_overrun_counter(); }
+void SPDLOG_INLINE thread_pool::post_flush(size_t logger_handle,
+                                           async_overflow_policy overflow_policy) {
+    async_msg flush_msg(logger_handle, async_msg_type::flush);
+    flush_msg.time = log_clock::now();
+    post_async_msg_(std::move(flush_msg), overflow_policy);
+}
 
-size_t SPDLOG_INLINE thread_pool::discard_counter() { return q_.discard_counter(); }
+size_t SPDLOG_INLINE thread_pool::overrun_counter() {
+    size_t rv = retired_overrun_counter_.load(std::memory_order_relaxed);
+    for (auto &target : shards_) {
+        rv += target.overrun_counter();
+    }
+    for_each_staging_queue_([&rv](staging_queue &sq) { rv += sq.q.overrun_counter(); });
+    return rv;
+}
 
-void SPDLOG_INLINE thread_pool::reset_discard_counter() { q_.reset_discard_counter(); }
+void SPDLOG_INLINE thread_pool::reset_overrun_counter() {
+    retired_overrun_counter_.store(0, std::memory_order_relaxed);
+    for (auto &target : shards_) {
+        target.reset_overrun_counter();
+    }
+    for_each_staging_queue_([](staging_queue &sq) { sq.q.reset_overrun_counter(); });
+}
 
-size_t SPDLOG_INLINE thread_pool::queue_size() { return q_.size(); }
+size_t SPDLOG_INLINE thread_pool::discard_counter() {
+    size_t rv = retired_discard_counter_.load(std::memory_order_relaxed);
+    for (auto &target : shards_) {
+        rv += target.discard_counter();
+    }
+    for_each_staging_queue_([&rv](staging_queue &sq) { rv += sq.q.discard_counter(); });
+    return rv;
+}
+
+void SPDLOG_INLINE thread_pool::reset_discard_counter() {
+    retired_discard_counter_.store(0, std::memory_order_relaxed);
+    for (auto &target : shards_) {
+        target.reset_discard_counter();
+    }
+    for_each_staging_queue_([](staging_queue &sq) { sq.q.reset_discard_counter(); });
+}
+
+size_t SPDLOG_INLINE thread_pool::queue_size() {
+    size_t rv = 0;
+    for (auto &target : shards_) {
+        rv += target.size();
+    }
+    for_each_staging_queue_([&rv](staging_queue &sq) { rv += sq.q.size(); });
+    return rv;
+}
+
+size_t SPDLOG_INLINE thread_pool::shard::overrun_counter() {
+    if (lockfree_q) {
+        return lockfree_q->overrun_counter();
+    }
+    if (arena_q) {
+        return arena_q->overrun_counter();
+    }
+    return q->overrun_counter();
+}
+
+void SPDLOG_INLINE thread_pool::shard::reset_overrun_counter() {
+    if (lockfree_q) {
+        lockfree_q->reset_overrun_counter();
+    } else if (arena_q) {
+        arena_q->reset_overrun_counter();
+    } else {
+        q->reset_overrun_counter();
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::shard::discard_counter() {
+    if (lockfree_q) {
+        return lockfree_q->discard_counter();
+    }
+    if (arena_q) {
+        return arena_q->discard_counter();
+    }
+    return q->discard_counter();
+}
+
+void SPDLOG_INLINE thread_pool::shard::reset_discard_counter() {
+    if (lockfree_q) {
+        lockfree_q->reset_discard_counter();
+    } else if (arena_q) {
+        arena_q->reset_discard_counter();
+    } else {
+        q->reset_discard_counter();
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::shard::size() {
+    if (lockfree_q) {
+        return lockfree_q->size();
+    }
+    if (arena_q) {
+        return arena_q->size();
+    }
+    return q->size();
+}
+
+SPDLOG_INLINE size_t thread_pool::shard_of_(const std::vector<sink_ptr> &sinks) {
+    if (shards_.size() <= 1) {
+        return 0;
+    }
+    std::vector<const void *> sink_set;
+    for (auto &sink : sinks) {
+        sink_set.push_back(sink.get());
+    }
+    std::sort(sink_set.begin(), sink_set.end());
+    std::lock_guard<std::mutex> lock(sink_sets_mutex_);
+    auto it = sink_set_shards_.find(sink_set);
+    if (it != sink_set_shards_.end()) {
+        return it->second;
+    }
+    auto rv = sink_set_shards_.size() % shards_.size();
+    sink_set_shards_.emplace(std::move(sink_set), rv);
+    return rv;
+}
 
 void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg,
                                                 async_overflow_policy overflow_policy) {
+    if (!staging_workers_.empty()) {
+        post_staged_msg_(std::move(new_msg), overflow_policy);
+        return;
+    }
+    auto &target = shards_[shards_.size() > 1 ? logger_of_(new_msg)->shard_ : 0];
+    post_to_shard_(target, std::move(new_msg), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::post_to_shard_(shard &target,
+                                               async_msg &&new_msg,
+                                               async_overflow_policy overflow_policy) {
+    if (target.lockfree_q) {
+        enqueue_msg_(*target.lockfree_q, std::move(new_msg), overflow_policy);
+    } else if (target.arena_q) {
+        post_record_(target, new_msg.msg_type, std::move(new_msg.worker_ptr),
+                     new_msg.logger_handle, new_msg, overflow_policy);
+    } else {
+        enqueue_msg_(*target.q, std::move(new_msg), overflow_policy);
+    }
+}
+
+template <typename Queue>
+void SPDLOG_INLINE thread_pool::enqueue_msg_(Queue &q,
+                                             async_msg &&new_msg,
+                                             async_overflow_policy overflow_policy) {
+    if (overflow_policy == async_overflow_policy::block) {
+        q.enqueue(std::move(new_msg));
+    } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
+        q.enqueue_nowait(std::move(new_msg));
+    } else {
+        assert(overflow_policy == async_overflow_policy::discard_new);
+        q.enqueue_if_have_room(std::move(new_msg));
+    }
+}
+
+void SPDLOG_INLINE thread_pool::post_record_(shard &target,
+                                             async_msg_type msg_type,
+                                             async_logger_ptr &&worker_ptr,
+                                             size_t logger_handle,
+                                             const details::log_msg &msg,
+                                             async_overflow_policy overflow_policy) {
+    async_record record(msg_type, std::move(worker_ptr), logger_handle, msg);
+    auto payload = msg.payload;
+    auto &q = *target.arena_q;
+    if (overflow_policy == async_overflow_policy::block) {
+        q.enqueue(std::move(record), payload.data(), payload.size());
+    } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
+        q.enqueue_nowait(std::move(record), payload.data(), payload.size());
+    } else {
+        assert(overflow_policy == async_overflow_policy::discard_new);
+        q.enqueue_if_have_room(std::move(record), payload.data(), payload.size());
+    }
+}
+
+void SPDLOG_INLINE thread_pool::post_staged_msg_(async_msg &&new_msg,
+                                                 async_overflow_policy overflow_policy) {
+    auto &sq = thread_staging_queue_();
+    auto &worker = *staging_workers_[sq.worker_index];
     if (overflow_policy == async_overflow_policy::block) {
-        q_.enqueue(std::move(new_msg));
+        if (!sq.q.try_enqueue(new_msg)) {
+            worker.room.spin_wait([&sq, &new_msg] { return sq.q.try_enqueue(new_msg); });
+        }
     } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
-        q_.enqueue_nowait(std::move(new_msg));
+        sq.q.force_enqueue(new_msg);
     } else {
         assert(overflow_policy == async_overflow_policy::discard_new);
-        q_.enqueue_if_have_room(std::move(new_msg));
+        if (!sq.q.try_enqueue_or_discard(new_msg)) {
+            return;
+        }
     }
+    worker.work.notify_one();
 }
 
-void SPDLOG_INLINE thread_pool::worker_loop_() {
-    while (process_next_msg_()) {
+void SPDLOG_INLINE thread_pool::worker_loop_(size_t worker_index) {
+    if (!staging_workers_.empty()) {
+        staging_worker_loop_(*staging_workers_[worker_index]);
+        return;
+    }
+    auto &source = shards_[worker_index % shards_.size()];
+    if (source.arena_q) {
+        async_msg_batch batch(max_batch_size_);
+        batch.records.resize(max_batch_size_);
+        while (process_next_records_(source, batch)) {
+        }
+        return;
+    }
+    if (max_batch_size_ > 1) {
+        async_msg_batch batch(max_batch_size_);
+        batch.msgs.resize(max_batch_size_);
+        while (process_next_batch_(source, batch)) {
+        }
+        return;
+    }
+    while (process_next_msg_(source)) {
     }
 }
 
 // process next message in the queue
 // return true if this thread should still be active (while no terminate msg
 // was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_() {
+bool SPDLOG_INLINE thread_pool::process_next_msg_(shard &source) {
     async_msg incoming_async_msg;
-    q_.dequeue(incoming_async_msg);
+    if (source.lockfree_q) {
+        source.lockfree_q->dequeue(incoming_async_msg);
+    } else {
+        source.q->dequeue(incoming_async_msg);
+    }
+    return handle_msg_(incoming_async_msg);
+}
 
-    switch (incoming_async_msg.msg_type) {
+bool SPDLOG_INLINE thread_pool::process_next_batch_(shard &source, async_msg_batch &batch) {
+    auto *msgs = batch.msgs.data();
+    if (source.lockfree_q) {
+        batch.size = source.lockfree_q->dequeue_bulk(msgs, batch.msgs.size());
+    } else {
+        batch.size = source.q->dequeue_bulk(msgs, batch.msgs.size());
+    }
+    auto terminate_msgs = handle_batch_(batch);
+    repost_terminate_msgs_(source, terminate_msgs);
+    return terminate_msgs == 0;
+}
+
+bool SPDLOG_INLINE thread_pool::process_next_records_(shard &source, async_msg_batch &batch) {
+    auto *records = batch.records.data();
+    batch.size = source.arena_q->dequeue_bulk(records, batch.records.size());
+    // the payloads are used in place
+    for (size_t i = 0; i < batch.size; i++) {
+        records[i]->item.payload = string_view_t{records[i]->extra(), records[i]->extra_size};
+    }
+    auto terminate_msgs = dispatch_batch_(
+        batch.size, [records](size_t i) -> async_record & { return records[i]->item; }, batch);
+    source.arena_q->release(records, batch.size);
+    batch.size = 0;
+    repost_terminate_msgs_(source, terminate_msgs);
+    return terminate_msgs == 0;
+}
+
+bool SPDLOG_INLINE thread_pool::handle_msg_(async_msg &msg) {
+    switch (msg.msg_type) {
         case async_msg_type::log: {
-            incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
+            if (auto *logger = logger_of_(msg)) {
+                logger->backend_sink_it_(msg);
+            }
+            return true;
+        }
+        case async_msg_type::log_deferred: {
+            auto *logger = logger_of_(msg);
+            memory_buf_t buf;
+            if (logger && logger->backend_format_(buf, msg)) {
+                log_msg formatted(msg);
+                formatted.payload = string_view_t(buf.data(), buf.size());
+                logger->backend_sink_it_(formatted);
+            }
             return true;
         }
         case async_msg_type::flush: {
-            incoming_async_msg.worker_ptr->backend_flush_();
+            if (auto *logger = logger_of_(msg)) {
+                logger->backend_flush_();
+            }
+            return true;
+        }
+
+        case async_msg_type::drain: {
+            wait_at_drain_barrier_(msg.logger_handle);
             return true;
         }
 
@@ -123,5 +470,368 @@ bool SPDLOG_INLINE thread_pool::process_next_msg_() {
     return true;
 }
 
+size_t SPDLOG_INLINE thread_pool::handle_batch_(async_msg_batch &batch) {
+    auto *msgs = batch.msgs.data();
+    auto terminate_msgs = dispatch_batch_(
+        batch.size, [msgs](size_t i) -> async_msg & { return msgs[i]; }, batch);
+
+    // release the loggers now, the batch may stay untouched for a long time
+    for (size_t i = 0; i < batch.size; i++) {
+        msgs[i].worker_ptr.reset();
+    }
+    batch.size = 0;
+    return terminate_msgs;
+}
+
+template <typename GetMsg>
+size_t SPDLOG_INLINE thread_pool::dispatch_batch_(size_t count,
+                                                  GetMsg get_msg,
+                                                  async_msg_batch &batch) {
+    format_deferred_msgs_(count, get_msg, batch);
+    auto &run = batch.run;
+    size_t terminate_msgs = 0;
+    size_t i = 0;
+    while (i < count) {
+        auto &msg = get_msg(i);
+        // terminate msgs, and deferred msgs that failed to format
+        if (msg.msg_type == async_msg_type::terminate ||
+            msg.msg_type == async_msg_type::log_deferred) {
+            terminate_msgs += msg.msg_type == async_msg_type::terminate ? 1 : 0;
+            i++;
+            continue;
+        }
+        if (msg.msg_type == async_msg_type::drain) {
+            wait_at_drain_barrier_(msg.logger_handle);
+            i++;
+            continue;
+        }
+        auto *logger = logger_of_(msg);
+        if (logger == nullptr) {
+            i++;  // of a logger destroyed by a worker (see unregister_logger_)
+            continue;
+        }
+        if (msg.msg_type == async_msg_type::flush) {
+            logger->backend_flush_();
+            i++;
+            continue;
+        }
+        // collect the following log messages of the same logger
+        run.clear();
+        while (i < count && get_msg(i).msg_type == async_msg_type::log &&
+               logger_of_(get_msg(i)) == logger) {
+            run.push_back(&get_msg(i));
+            i++;
+        }
+        if (run.size() == 1) {
+            logger->backend_sink_it_(msg);
+        } else {
+            logger->backend_sink_batch_(run.data(), run.size());
+        }
+    }
+    return terminate_msgs;
+}
+
+template <typename GetMsg>
+void SPDLOG_INLINE thread_pool::format_deferred_msgs_(size_t count,
+                                                      GetMsg get_msg,
+                                                      async_msg_batch &batch) {
+    // the buffer may grow while formatting: set the payloads once all are formatted
+    const size_t failed_to_format = static_cast<size_t>(-1);
+    batch.formatted.clear();
+    batch.formatted_ends.clear();
+    for (size_t i = 0; i < count; i++) {
+        auto &msg = get_msg(i);
+        if (msg.msg_type == async_msg_type::log_deferred) {
+            auto begin = batch.formatted.size();
+            auto *logger = logger_of_(msg);
+            if (logger && logger->backend_format_(batch.formatted, msg)) {
+                batch.formatted_ends.push_back(batch.formatted.size());
+            } else {
+                batch.formatted.resize(begin);
+                batch.formatted_ends.push_back(failed_to_format);
+            }
+        }
+    }
+
+    size_t begin = 0;
+    auto end = batch.formatted_ends.begin();
+    for (size_t i = 0; i < count && end != batch.formatted_ends.end(); i++) {
+        auto &msg = get_msg(i);
+        if (msg.msg_type != async_msg_type::log_deferred) {
+            continue;
+        }
+        if (*end != failed_to_format) {
+            msg.payload = string_view_t(batch.formatted.data() + begin, *end - begin);
+            msg.msg_type = async_msg_type::log;
+            begin = *end;
+        }
+        ++end;
+    }
+}
+
+void SPDLOG_INLINE thread_pool::repost_terminate_msgs_(shard &source, size_t terminate_msgs) {
+    for (size_t i = 1; i < terminate_msgs; i++) {
+        post_to_shard_(source, async_msg(async_msg_type::terminate), async_overflow_policy::block);
+    }
+}
+
+SPDLOG_INLINE size_t thread_pool::register_logger_(async_logger *logger) {
+    std::lock_guard<std::mutex> lock(loggers_mutex_);
+    size_t handle;
+    if (!free_logger_handles_.empty()) {
+        handle = free_logger_handles_.back();
+        free_logger_handles_.pop_back();
+    } else {
+        if (next_logger_handle_ == logger_chunk_size * max_logger_chunks) {
+            throw_spdlog_ex("thread_pool: too many registered loggers");
+        }
+        handle = next_logger_handle_++;
+    }
+    auto &chunk = logger_chunks_[handle / logger_chunk_size];
+    if (!chunk) {
+        chunk.reset(new async_logger *[logger_chunk_size]);
+    }
+    chunk[handle % logger_chunk_size] = logger;
+    return handle;
+}
+
+SPDLOG_INLINE void thread_pool::unregister_logger_(size_t logger_handle) {
+    auto calling_worker = calling_worker_();
+    if (calling_worker == threads_.size()) {
+        std::vector<size_t> retired;
+        {
+            std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+            {
+                std::lock_guard<std::mutex> lock(loggers_mutex_);
+                retired.swap(retired_logger_handles_);
+            }
+            drain_workers_(threads_.size(), calling_worker);
+        }
+        // all the messages of the logger, and of the loggers retired before the drain, were
+        // processed: their handles can be reused
+        std::lock_guard<std::mutex> lock(loggers_mutex_);
+        logger_chunks_[logger_handle / logger_chunk_size][logger_handle % logger_chunk_size] =
+            nullptr;
+        free_logger_handles_.push_back(logger_handle);
+        free_logger_handles_.insert(free_logger_handles_.end(), retired.begin(), retired.end());
+        return;
+    }
+
+    // destroyed by a worker (e.g. a sink released the last reference to the logger), which can't
+    // wait for itself. wait for the other workers only if no other drain is running: it may be
+    // waiting for this one. the messages of the logger still queued are dropped, and its handle
+    // is reused only after the next drain of all the workers.
+    {
+        std::unique_lock<std::mutex> drain_lock(drain_mutex_, std::try_to_lock);
+        if (drain_lock.owns_lock() && threads_.size() > 1) {
+            drain_workers_(threads_.size() - 1, calling_worker);
+        }
+    }
+    std::lock_guard<std::mutex> lock(loggers_mutex_);
+    logger_chunks_[logger_handle / logger_chunk_size][logger_handle % logger_chunk_size] = nullptr;
+    retired_logger_handles_.push_back(logger_handle);
+}
+
+SPDLOG_INLINE size_t thread_pool::calling_worker_() const {
+    auto id = std::this_thread::get_id();
+    for (size_t i = 0; i < threads_.size(); i++) {
+        if (threads_[i].get_id() == id) {
+            return i;
+        }
+    }
+    return threads_.size();
+}
+
+SPDLOG_INLINE void thread_pool::drain_workers_(size_t workers_n, size_t calling_worker) {
+    std::unique_lock<std::mutex> lock(barrier_mutex_);
+    auto generation = barrier_generation_;
+    lock.unlock();
+    post_drain_msgs_(generation, workers_n, calling_worker);
+    lock.lock();
+    // drain msgs can be overrun by other loggers, or a worker can take two of them in a batch.
+    // post again the missing ones if it takes long. the extra ones will be ignored.
+    while (!barrier_cv_.wait_for(lock, std::chrono::milliseconds(10),
+                                 [&] { return barrier_arrived_ == workers_n; })) {
+        // with sharded queues, the missing ones could belong to any shard
+        auto missing = shards_.size() > 1 ? workers_n : workers_n - barrier_arrived_;
+        lock.unlock();
+        post_drain_msgs_(generation, missing, calling_worker);
+        lock.lock();
+    }
+    barrier_arrived_ = 0;
+    barrier_generation_++;
+    barrier_cv_.notify_all();
+}
+
+SPDLOG_INLINE async_logger *thread_pool::registered_logger_(size_t logger_handle) {
+    return logger_chunks_[logger_handle / logger_chunk_size][logger_handle % logger_chunk_size];
+}
+
+SPDLOG_INLINE void thread_pool::post_drain_msgs_(size_t generation,
+                                                  size_t count,
+                                                  size_t calling_worker) {
+    for (size_t i = 0, posted = 0; posted < count; i++) {
+        // the shard of the calling worker would never be read
+        if (shards_.size() > 1 && i % shards_.size() == calling_worker) {
+            continue;
+        }
+        post_to_shard_(shards_[i % shards_.size()], async_msg(generation, async_msg_type::drain),
+                       async_overflow_policy::block);
+        posted++;
+    }
+}
+
+SPDLOG_INLINE void thread_pool::wait_at_drain_barrier_(size_t generation) {
+    std::unique_lock<std::mutex> lock(barrier_mutex_);
+    if (generation != barrier_generation_) {
+        return;  // extra msg of a completed drain
+    }
+    barrier_arrived_++;
+    barrier_cv_.notify_all();
+    barrier_cv_.wait(lock, [this, generation] { return barrier_generation_ != generation; });
+}
+
+template <typename Msg>
+SPDLOG_INLINE async_logger *thread_pool::logger_of_(const Msg &msg) {
+    return msg.worker_ptr ? msg.worker_ptr.get() : registered_logger_(msg.logger_handle);
+}
+
+// return the staging queue of the calling thread. register a new one on its first message.
+SPDLOG_INLINE staging_queue &thread_pool::thread_staging_queue_() {
+#ifndef SPDLOG_NO_TLS
+    static thread_local thread_staging_queues tls;
+    auto &queues = tls.queues;
+#else
+    static thread_staging_queues never_used;  // per_thread is disabled when TLS is not available
+    auto &queues = never_used.queues;
+#endif
+    for (auto &sq : queues) {
+        if (sq->pool_id == id_) {
+            return *sq;
+        }
+    }
+
+    // first message from this thread to this pool. forget queues of destroyed pools
+    queues.erase(std::remove_if(queues.begin(), queues.end(),
+                                [](const std::shared_ptr<staging_queue> &sq) {
+                                    return sq->pool_closed.load(std::memory_order_relaxed);
+                                }),
+                 queues.end());
+
+    auto worker_index =
+        next_staging_worker_.fetch_add(1, std::memory_order_relaxed) % staging_workers_.size();
+    auto new_queue = std::make_shared<staging_queue>(q_max_items_, id_, worker_index);
+    auto &worker = *staging_workers_[worker_index];
+    {
+        std::lock_guard<std::mutex> lock(worker.queues_mutex);
+        worker.queues.push_back(new_queue);
+        worker.version.fetch_add(1, std::memory_order_release);
+    }
+    queues.push_back(new_queue);
+    return *new_queue;
+}
+
+// drain the worker's staging queues, oldest message first, until the pool is destroyed.
+SPDLOG_INLINE void thread_pool::staging_worker_loop_(staging_worker &worker) {
+    std::vector<std::shared_ptr<staging_queue>> queues;
+    size_t version = 0;
+    async_msg_batch batch(max_batch_size_);
+    batch.msgs.resize(max_batch_size_);
+    auto has_pending_msgs = [&queues] {
+        for (auto &sq : queues) {
+            if (sq->q.size() > 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (;;) {
+        // read the stop flag first: the queues must be found empty *after* it was set
+        bool stopping = staging_stop_.load(std::memory_order_acquire);
+        if (worker.version.load(std::memory_order_acquire) != version) {
+            std::lock_guard<std::mutex> lock(worker.queues_mutex);
+            queues = worker.queues;
+            version = worker.version.load(std::memory_order_relaxed);
+        }
+
+        // keep the oldest message of each queue aside and take the oldest of them,
+        // up to max_batch_size_ times
+        bool found_exited = false;
+        while (batch.size < batch.msgs.size()) {
+            staging_queue *oldest = nullptr;
+            found_exited = false;
+            for (auto &sq : queues) {
+                if (!sq->has_next) {
+                    bool exited = sq->producer_exited.load(std::memory_order_acquire);
+                    sq->has_next = sq->q.try_dequeue(sq->next);
+                    if (!sq->has_next) {
+                        found_exited = found_exited || exited;
+                        continue;
+                    }
+                }
+                if (oldest == nullptr || sq->next.time < oldest->next.time) {
+                    oldest = sq.get();
+                }
+            }
+            if (oldest == nullptr) {
+                break;
+            }
+            oldest->has_next = false;
+            batch.msgs[batch.size++] = std::move(oldest->next);
+        }
+
+        if (batch.size > 0) {
+            worker.room.notify_all();
+            handle_batch_(batch);
+            continue;
+        }
+
+        if (found_exited) {
+            retire_staging_queues_(worker);
+            continue;
+        }
+
+        if (stopping) {
+            return;
+        }
+
+        worker.work.wait(
+            [this, &worker, &version, &has_pending_msgs] {
+                return staging_stop_.load(std::memory_order_relaxed) ||
+                       worker.version.load(std::memory_order_relaxed) != version ||
+                       has_pending_msgs();
+            },
+            wait_policy_);
+    }
+}
+
+// remove the drained queues of threads that have exited
+SPDLOG_INLINE void thread_pool::retire_staging_queues_(staging_worker &worker) {
+    std::lock_guard<std::mutex> lock(worker.queues_mutex);
+    auto is_retired = [this](const std::shared_ptr<staging_queue> &sq) {
+        if (!sq->producer_exited.load(std::memory_order_acquire) || sq->has_next ||
+            sq->q.size() > 0) {
+            return false;
+        }
+        retired_overrun_counter_.fetch_add(sq->q.overrun_counter(), std::memory_order_relaxed);
+        retired_discard_counter_.fetch_add(sq->q.discard_counter(), std::memory_order_relaxed);
+        return true;
+    };
+    auto &queues = worker.queues;
+    queues.erase(std::remove_if(queues.begin(), queues.end(), is_retired), queues.end());
+    worker.version.fetch_add(1, std::memory_order_release);
+}
+
+template <typename Func>
+void SPDLOG_INLINE thread_pool::for_each_staging_queue_(Func func) {
+    for (auto &worker : staging_workers_) {
+        std::lock_guard<std::mutex> lock(worker->queues_mutex);
+        for (auto &sq : worker->queues) {
+            func(*sq);
+        }
+    }
+}
+
 }  // namespace details
 }  // namespace spdlog
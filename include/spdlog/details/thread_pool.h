@@ -3,30 +3,75 @@
 
 #pragma once
 
+#include <spdlog/details/arena_q.h>
 #include <spdlog/details/log_msg_buffer.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/parking_spot.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 namespace spdlog {
 class async_logger;
 
+// Queue implementation used to pass messages from the loggers to the thread pool workers.
+enum class async_queue_type {
+    mutex,       // mpmc_blocking_queue - circular buffer guarded by a single mutex (default)
+    lock_free,   // mpmc_lockfree_queue - lock free ring buffer. the lock is taken only to wake up
+                 // parked threads. The queue size is rounded up to the next power of two.
+    per_thread,  // each producing thread gets its own lock free queue (of q_max_items) on its
+                 // first message. The worker drains them all, merging the messages by time.
+                 // q_max_items is per thread, so it should be much smaller than usual.
+                 // Same as lock_free if SPDLOG_NO_TLS is defined.
+    arena        // arena_queue - the messages and their payloads are written in place in a ring
+                 // of q_max_items * 192 bytes, without any allocation. guarded by a single mutex.
+};
+
+// Optional thread pool settings
+struct thread_pool_options {
+    async_queue_type queue_type = async_queue_type::mutex;
+    // max number of messages a worker takes from the queue at once. consecutive messages of the
+    // same logger are passed to its sinks together with sink::log_batch().
+    size_t max_batch_size = 1;
+    // async loggers register with the pool and get a small integer handle. their messages carry
+    // this handle instead of a shared_ptr, and the loggers keep the pool alive. so no reference
+    // count is touched when logging. a logger waits for the workers to log all its messages
+    // when destroyed, unless destroyed by a worker, which drops those it didn't take yet.
+    // ignored by async_queue_type::per_thread.
+    bool logger_handles = false;
+    // each worker gets its own queue (of q_max_items). all the messages of a logger go to the
+    // same worker, chosen by the set of sinks of the logger when it was created. so the messages
+    // of a logger (and of loggers sharing the same sinks) stay in order, while loggers writing to
+    // different sinks are spread over the workers. ignored by async_queue_type::per_thread.
+    bool sharded = false;
+    // how the workers wait for new messages. spinning (opt-in) saves the producers the wake up
+    // calls (they notify a worker only if it sleeps), at the cost of cpu time.
+    async_wait_policy wait_policy = async_wait_policy::block;
+};
+
 namespace details {
 
 using async_logger_ptr = std::shared_ptr<spdlog::async_logger>;
 
-enum class async_msg_type { log, flush, terminate };
+// log_deferred: the payload holds the captured arguments, formatted by the worker
+// (see async_logger::set_deferred_formatting())
+enum class async_msg_type { log, log_deferred, flush, terminate, drain };
 
 // Async msg to move to/from the queue
 // Movable only. should never be copied
 struct async_msg : log_msg_buffer {
     async_msg_type msg_type{async_msg_type::log};
     async_logger_ptr worker_ptr;
+    size_t logger_handle{0};  // used instead of worker_ptr if null (see register_logger_)
 
     async_msg() = default;
     ~async_msg() = default;
@@ -39,12 +84,14 @@ struct async_msg : log_msg_buffer {
     async_msg(async_msg &&other)
         : log_msg_buffer(std::move(other)),
           msg_type(other.msg_type),
-          worker_ptr(std::move(other.worker_ptr)) {}
+          worker_ptr(std::move(other.worker_ptr)),
+          logger_handle(other.logger_handle) {}
 
     async_msg &operator=(async_msg &&other) {
         *static_cast<log_msg_buffer *>(this) = std::move(other);
         msg_type = other.msg_type;
         worker_ptr = std::move(other.worker_ptr);
+        logger_handle = other.logger_handle;
         return *this;
     }
 #else  // (_MSC_VER) && _MSC_VER <= 1800
@@ -63,20 +110,97 @@ struct async_msg : log_msg_buffer {
           msg_type{the_type},
           worker_ptr{std::move(worker)} {}
 
+    // construct from log_msg of a registered logger
+    async_msg(size_t handle, async_msg_type the_type, const details::log_msg &m)
+        : log_msg_buffer{m},
+          msg_type{the_type},
+          logger_handle{handle} {}
+
+    async_msg(size_t handle, async_msg_type the_type)
+        : log_msg_buffer{},
+          msg_type{the_type},
+          logger_handle{handle} {}
+
     explicit async_msg(async_msg_type the_type)
         : async_msg{nullptr, the_type} {}
 };
 
+// Async msg written in place in the arena (async_queue_type::arena).
+// Its payload is stored right after it.
+struct async_record : log_msg {
+    async_msg_type msg_type{async_msg_type::log};
+    async_logger_ptr worker_ptr;
+    size_t logger_handle{0};
+
+    async_record(async_msg_type the_type,
+                 async_logger_ptr &&worker,
+                 size_t handle,
+                 const details::log_msg &m)
+        : log_msg{m},
+          msg_type{the_type},
+          worker_ptr{std::move(worker)},
+          logger_handle{handle} {}
+};
+
+// messages taken from the queue at once by a worker
+struct async_msg_batch {
+    explicit async_msg_batch(size_t max_size);
+
+    std::vector<async_msg> msgs;
+    std::vector<arena_queue<async_record>::record *> records;  // async_queue_type::arena
+    size_t size = 0;
+    std::vector<const log_msg *> run;  // consecutive log messages of the same logger
+    memory_buf_t formatted;            // payloads of the log_deferred messages
+    std::vector<size_t> formatted_ends;
+};
+
+// Queue of a single producing thread (async_queue_type::per_thread)
+struct staging_queue {
+    staging_queue(size_t max_items, size_t owner_pool_id, size_t owner_worker_index)
+        : q(max_items),
+          pool_id(owner_pool_id),
+          worker_index(owner_worker_index) {}
+
+    mpmc_lockfree_queue<async_msg> q;
+    const size_t pool_id;
+    const size_t worker_index;
+    std::atomic<bool> producer_exited{false};
+    std::atomic<bool> pool_closed{false};
+
+    // owned by the worker thread: oldest message taken from q and not processed yet
+    async_msg next;
+    bool has_next = false;
+};
+
+// The staging queues drained by one worker thread
+struct staging_worker {
+    parking_spot work;  // the worker waits here for new messages
+    parking_spot room;  // producers wait here for room in their (full) queues
+    std::mutex queues_mutex;
+    std::vector<std::shared_ptr<staging_queue>> queues;
+    std::atomic<size_t> version{0};  // incremented on each change of queues
+};
+
 class SPDLOG_API thread_pool {
+    friend class spdlog::async_logger;
+
 public:
     using item_type = async_msg;
     using q_type = details::mpmc_blocking_queue<item_type>;
+    using lockfree_q_type = details::mpmc_lockfree_queue<item_type>;
+    using arena_q_type = details::arena_queue<async_record>;
 
+    thread_pool(size_t q_max_items,
+                size_t threads_n,
+                std::function<void()> on_thread_start,
+                std::function<void()> on_thread_stop,
+                const thread_pool_options &options);
     thread_pool(size_t q_max_items,
                 size_t threads_n,
                 std::function<void()> on_thread_start,
                 std::function<void()> on_thread_stop);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
+    thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options);
     thread_pool(size_t q_max_items, size_t threads_n);
 
     // message all threads to terminate gracefully and join them
@@ -85,10 +209,18 @@ public:
     thread_pool(const thread_pool &) = delete;
     thread_pool &operator=(thread_pool &&) = delete;
 
+    // msg_type is either log or log_deferred
     void post_log(async_logger_ptr &&worker_ptr,
                   const details::log_msg &msg,
-                  async_overflow_policy overflow_policy);
+                  async_overflow_policy overflow_policy,
+                  async_msg_type msg_type = async_msg_type::log);
     void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
+    // same, for loggers registered with the pool (thread_pool_options::logger_handles)
+    void post_log(size_t logger_handle,
+                  const details::log_msg &msg,
+                  async_overflow_policy overflow_policy,
+                  async_msg_type msg_type = async_msg_type::log);
+    void post_flush(size_t logger_handle, async_overflow_policy overflow_policy);
     size_t overrun_counter();
     void reset_overrun_counter();
     size_t discard_counter();
@@ -96,17 +228,134 @@ public:
     size_t queue_size();
 
 private:
-    q_type q_;
+    // arena size per q_max_items (async_queue_type::arena)
+    static SPDLOG_CONSTEXPR size_t arena_bytes_per_item = 192;
+
+    // queue shared by the workers, or owned by one worker (thread_pool_options::sharded).
+    // according to the queue type, one of the queues is allocated.
+    struct shard {
+        std::unique_ptr<q_type> q;
+        std::unique_ptr<lockfree_q_type> lockfree_q;
+        std::unique_ptr<arena_q_type> arena_q;
+
+        size_t overrun_counter();
+        void reset_overrun_counter();
+        size_t discard_counter();
+        void reset_discard_counter();
+        size_t size();
+    };
+
+    async_queue_type queue_type_;
+    std::vector<shard> shards_;
+    // async_queue_type::per_thread uses one staging_worker per thread instead of shards
+    std::vector<std::unique_ptr<staging_worker>> staging_workers_;
+
+    // sharded pools: shard of each distinct set of sinks, assigned round robin
+    std::mutex sink_sets_mutex_;
+    std::map<std::vector<const void *>, size_t> sink_set_shards_;
+
+    // async_queue_type::per_thread state
+    const size_t id_;  // unique id of this pool, to find the calling thread's staging queue
+    const size_t q_max_items_;
+    const size_t max_batch_size_;
+    const async_wait_policy wait_policy_;
+    std::atomic<size_t> next_staging_worker_{0};
+    std::atomic<bool> staging_stop_{false};
+    std::atomic<size_t> retired_overrun_counter_{0};
+    std::atomic<size_t> retired_discard_counter_{0};
 
     std::vector<std::thread> threads_;
 
+    // registered loggers (thread_pool_options::logger_handles), indexed by handle.
+    // the chunks never move, so the workers read them without locking: a handle is always
+    // registered before its messages are queued, and unregistered after they were all processed
+    // (by the other workers when unregistered by a worker, see unregister_logger_).
+    static SPDLOG_CONSTEXPR size_t logger_chunk_size = 64;
+    static SPDLOG_CONSTEXPR size_t max_logger_chunks = 256;
+    bool logger_handles_ = false;
+    std::mutex loggers_mutex_;
+    std::unique_ptr<async_logger *[]> logger_chunks_[max_logger_chunks];
+    size_t next_logger_handle_ = 0;
+    std::vector<size_t> free_logger_handles_;
+    // handles of the loggers destroyed by a worker, free after the next drain of all the workers
+    std::vector<size_t> retired_logger_handles_;
+
+    // drain barrier: every worker stops at a drain msg until all of them did
+    std::mutex drain_mutex_;  // one drain at a time
+    std::mutex barrier_mutex_;
+    std::condition_variable barrier_cv_;
+    size_t barrier_arrived_ = 0;
+    size_t barrier_generation_ = 0;
+
+    size_t register_logger_(async_logger *logger);
+    // wait until all the messages of the logger were processed, then free its handle
+    void unregister_logger_(size_t logger_handle);
+    async_logger *registered_logger_(size_t logger_handle);
+    // index of the worker running the calling thread, or threads_.size()
+    size_t calling_worker_() const;
+    // make workers_n workers, other than the calling one, stop at a drain msg: all the messages
+    // queued before were processed by them
+    void drain_workers_(size_t workers_n, size_t calling_worker);
+    void post_drain_msgs_(size_t generation, size_t count, size_t calling_worker);
+    void wait_at_drain_barrier_(size_t generation);
+
+    // the logger of a message: its worker_ptr or registered logger
+    template <typename Msg>
+    async_logger *logger_of_(const Msg &msg);
+
+    // shard of the logger, by its set of sinks (called by async_logger)
+    size_t shard_of_(const std::vector<sink_ptr> &sinks);
+
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
-    void worker_loop_();
+    void post_to_shard_(shard &target, async_msg &&new_msg, async_overflow_policy overflow_policy);
+    template <typename Queue>
+    void enqueue_msg_(Queue &q, async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void post_staged_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void post_record_(shard &target,
+                      async_msg_type msg_type,
+                      async_logger_ptr &&worker_ptr,
+                      size_t logger_handle,
+                      const details::log_msg &msg,
+                      async_overflow_policy overflow_policy);
+    void worker_loop_(size_t worker_index);
 
     // process next message in the queue
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_msg_(shard &source);
+
+    // same as process_next_msg_(), taking up to max_batch_size_ messages at once
+    bool process_next_batch_(shard &source, async_msg_batch &batch);
+
+    // return false if the msg is a terminate msg
+    bool handle_msg_(async_msg &msg);
+
+    // same as process_next_batch_(), working in place on the arena records
+    bool process_next_records_(shard &source, async_msg_batch &batch);
+
+    // return the number of terminate msgs in the batch
+    size_t handle_batch_(async_msg_batch &batch);
+
+    // pass the messages to their loggers. consecutive log messages of the same logger are passed
+    // together. get_msg(i) returns the i-th message (async_msg or async_record).
+    // return the number of terminate msgs.
+    template <typename GetMsg>
+    size_t dispatch_batch_(size_t count, GetMsg get_msg, async_msg_batch &batch);
+
+    // format the log_deferred messages of the batch into batch.formatted, and turn them into log
+    // messages. the ones that failed to format are left as log_deferred.
+    template <typename GetMsg>
+    void format_deferred_msgs_(size_t count, GetMsg get_msg, async_msg_batch &batch);
+
+    // each worker must get its own terminate msg: post back the extra ones
+    void repost_terminate_msgs_(shard &source, size_t terminate_msgs);
+
+    // async_queue_type::per_thread helpers
+    staging_queue &thread_staging_queue_();
+    void staging_worker_loop_(staging_worker &worker);
+    void retire_staging_queues_(staging_worker &worker);
+    template <typename Func>
+    void for_each_staging_queue_(Func func);
 };
 
 }  // namespace details
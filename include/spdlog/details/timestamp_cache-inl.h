@@ -0,0 +1,65 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/timestamp_cache.h>
+#endif
+
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/os.h>
+
+namespace spdlog {
+namespace details {
+
+// never destroyed: the loggers may still format from the destructors of other statics, or from
+// the thread pool draining its queue at exit
+SPDLOG_INLINE timestamp_cache &timestamp_cache::instance() {
+    static auto *s_instance = new timestamp_cache();
+    return *s_instance;
+}
+
+SPDLOG_INLINE std::shared_ptr<const timestamp> timestamp_cache::get(log_clock::time_point tp,
+                                                                    pattern_time_type time_type) {
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch());
+    auto &current = current_[time_type == pattern_time_type::local ? 0 : 1];
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current && current->secs == secs) {
+            return current;
+        }
+    }
+
+    // built out of the lock: localtime() may wait for the time zone lock
+    auto next = std::make_shared<timestamp>();
+    next->secs = secs;
+    auto t = log_clock::to_time_t(tp);
+    next->tm = time_type == pattern_time_type::local ? os::localtime(t) : os::gmtime(t);
+    next->utc_offset_minutes = os::utc_minutes_offset(next->tm);
+    auto &dest = next->datetime;
+    fmt_helper::append_int(next->tm.tm_year + 1900, dest);
+    dest.push_back('-');
+    fmt_helper::pad2(next->tm.tm_mon + 1, dest);
+    dest.push_back('-');
+    fmt_helper::pad2(next->tm.tm_mday, dest);
+    dest.push_back(' ');
+    fmt_helper::pad2(next->tm.tm_hour, dest);
+    dest.push_back(':');
+    fmt_helper::pad2(next->tm.tm_min, dest);
+    dest.push_back(':');
+    fmt_helper::pad2(next->tm.tm_sec, dest);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current && current->secs == secs) {
+        return current;  // built by another thread meanwhile
+    }
+    // keep the latest second: the messages of async loggers may come late
+    if (!current || current->secs < secs) {
+        current = next;
+    }
+    return next;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,54 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// process-wide cache of the current second, shared by the formatters of all the sinks.
+//
+// get() returns the timestamp of a second: its broken-down time, its utc offset and its date time
+// rendered once ("YYYY-MM-DD HH:MM:SS"). the last second of each time type is kept in an
+// immutable snapshot: the first caller of a new second builds the next one and swaps it in, the
+// other callers share it, and the holders of the previous one keep it until they release it.
+// so localtime() runs once per second for the whole process, instead of once per formatter.
+// the formatters call get() only when the second of their messages changes.
+
+#include <spdlog/common.h>
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+struct timestamp {
+    std::chrono::seconds secs{0};  // since epoch
+    std::tm tm{};                  // local or utc, by the time type
+    int utc_offset_minutes = 0;    // for %z
+    memory_buf_t datetime;         // "YYYY-MM-DD HH:MM:SS"
+};
+
+class SPDLOG_API timestamp_cache {
+public:
+    static timestamp_cache &instance();
+
+    timestamp_cache(const timestamp_cache &) = delete;
+    timestamp_cache &operator=(const timestamp_cache &) = delete;
+
+    // the timestamp of the second of tp
+    std::shared_ptr<const timestamp> get(log_clock::time_point tp, pattern_time_type time_type);
+
+private:
+    timestamp_cache() = default;
+
+    std::mutex mutex_;
+    std::shared_ptr<const timestamp> current_[2];  // the last second, local and utc
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "timestamp_cache-inl.h"
+#endif
@@ -6,6 +6,8 @@
 #include <spdlog/details/log_msg.h>
 #include <spdlog/fmt/fmt.h>
 
+#include <string>
+
 namespace spdlog {
 
 class formatter {
@@ -13,5 +15,9 @@ public:
     virtual ~formatter() = default;
     virtual void format(const details::log_msg &msg, memory_buf_t &dest) = 0;
     virtual std::unique_ptr<formatter> clone() const = 0;
+    // formatters returning the same non-empty key format any message the same way, so sinks
+    // using them can share the formatted message (see sinks::shared_format).
+    // empty by default: the formatter doesn't share its output.
+    virtual std::string format_key() const { return std::string{}; }
 };
 }  // namespace spdlog
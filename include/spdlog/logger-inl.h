@@ -22,7 +22,8 @@ SPDLOG_INLINE logger::logger(const logger &other)
       level_(other.level_.load(std::memory_order_relaxed)),
       flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
       custom_err_handler_(other.custom_err_handler_),
-      tracer_(other.tracer_) {}
+      tracer_(other.tracer_),
+      deferred_formatting_(other.deferred_formatting_) {}
 
 SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT
     : name_(std::move(other.name_)),
@@ -30,7 +31,8 @@ SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT
       level_(other.level_.load(std::memory_order_relaxed)),
       flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
       custom_err_handler_(std::move(other.custom_err_handler_)),
-      tracer_(std::move(other.tracer_))
+      tracer_(std::move(other.tracer_)),
+      deferred_formatting_(other.deferred_formatting_)
 
 {}
 
@@ -55,6 +57,7 @@ SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT {
 
     custom_err_handler_.swap(other.custom_err_handler_);
     std::swap(tracer_, other.tracer_);
+    std::swap(deferred_formatting_, other.deferred_formatting_);
 }
 
 SPDLOG_INLINE void swap(logger &a, logger &b) { a.swap(b); }
@@ -133,9 +136,18 @@ SPDLOG_INLINE void logger::log_it_(const spdlog::details::log_msg &log_msg,
 }
 
 SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg) {
+    // sinks with equivalent formatters format the message once
+    sinks::shared_format shared;
+    bool share_format = sinks_.size() > 1;
     for (auto &sink : sinks_) {
         if (sink->should_log(msg.level)) {
-            SPDLOG_TRY { sink->log(msg); }
+            SPDLOG_TRY {
+                if (share_format) {
+                    sink->log_shared(msg, shared);
+                } else {
+                    sink->log(msg);
+                }
+            }
             SPDLOG_LOGGER_CATCH(msg.source)
         }
     }
@@ -145,6 +157,15 @@ SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg) {
     }
 }
 
+// no thread to defer to: format right away
+SPDLOG_INLINE void logger::sink_deferred_(const details::log_msg &msg) {
+    memory_buf_t buf;
+    details::format_deferred(buf, msg.payload);
+    details::log_msg formatted(msg);
+    formatted.payload = string_view_t(buf.data(), buf.size());
+    sink_it_(formatted);
+}
+
 SPDLOG_INLINE void logger::flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -16,8 +16,13 @@
 
 #include <spdlog/common.h>
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/deferred_args.h>
 #include <spdlog/details/log_msg.h>
 
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+    #include <spdlog/details/compiled_format.h>
+#endif
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     #ifndef _WIN32
         #error SPDLOG_WCHAR_TO_UTF8_SUPPORT only supported on windows
@@ -92,7 +97,8 @@ public:
 
     // T cannot be statically converted to format string (including string_view/wstring_view)
     template <class T,
-              typename std::enable_if<!is_convertible_to_any_format_string<const T &>::value,
+              typename std::enable_if<!is_convertible_to_any_format_string<const T &>::value &&
+                                          !is_compiled_format_string<T>::value,
                                       int>::type = 0>
     void log(source_loc loc, level::level_enum lvl, const T &msg) {
         log(loc, lvl, "{}", msg);
@@ -228,6 +234,65 @@ public:
     }
 #endif
 
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+    // format strings parsed at compile time, e.g. FMT_COMPILE("{} {}")
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void log(source_loc loc, level::level_enum lvl, const S &fmt, Args &&...args) {
+        log_compiled_(loc, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void log(level::level_enum lvl, const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void trace(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::trace, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void debug(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::debug, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void info(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::info, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void warn(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::warn, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void error(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::err, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename S,
+              typename... Args,
+              typename std::enable_if<is_compiled_format_string<S>::value, int>::type = 0>
+    void critical(const S &fmt, Args &&...args) {
+        log_compiled_(source_loc{}, level::critical, fmt, std::forward<Args>(args)...);
+    }
+#endif
+
     template <typename T>
     void trace(const T &msg) {
         log(level::trace, msg);
@@ -311,6 +376,8 @@ protected:
     spdlog::level_t flush_level_{level::off};
     err_handler custom_err_handler_{nullptr};
     details::backtracer tracer_;
+    // capture the arguments and let sink_deferred_() format them (see async_logger)
+    bool deferred_formatting_{false};
 
     // common implementation for after templated public api has been resolved
     template <typename... Args>
@@ -322,6 +389,16 @@ protected:
         }
         SPDLOG_TRY {
             memory_buf_t buf;
+            // the backtracer keeps formatted messages
+            if (deferred_formatting_ && !traceback_enabled) {
+                if (details::capture_deferred(buf, fmt, args...)) {
+                    details::log_msg log_msg(loc, name_, lvl,
+                                             string_view_t(buf.data(), buf.size()));
+                    sink_deferred_(log_msg);
+                    return;
+                }
+                buf.clear();
+            }
 #ifdef SPDLOG_USE_STD_FORMAT
             fmt_lib::vformat_to(std::back_inserter(buf), fmt, fmt_lib::make_format_args(args...));
 #else
@@ -334,6 +411,31 @@ protected:
         SPDLOG_LOGGER_CATCH(loc)
     }
 
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+    template <typename S, typename... Args>
+    void log_compiled_(source_loc loc, level::level_enum lvl, const S &fmt, Args &&...args) {
+        // the capture only needs the format string
+        if (deferred_formatting_) {
+            log_(loc, lvl, static_cast<string_view_t>(fmt), std::forward<Args>(args)...);
+            return;
+        }
+        bool log_enabled = should_log(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        if (!log_enabled && !traceback_enabled) {
+            return;
+        }
+        SPDLOG_TRY {
+            memory_buf_t buf;
+            // reserve once, rather than growing the buffer while formatting
+            buf.reserve(details::format_size_hint(fmt, args...));
+            fmt::format_to(fmt::appender(buf), fmt, std::forward<Args>(args)...);
+            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+            log_it_(log_msg, log_enabled, traceback_enabled);
+        }
+        SPDLOG_LOGGER_CATCH(loc)
+    }
+#endif
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     template <typename... Args>
     void log_(source_loc loc, level::level_enum lvl, wstring_view_t fmt, Args &&...args) {
@@ -361,6 +463,8 @@ protected:
     // and save backtrace (if backtrace is enabled).
     void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
     virtual void sink_it_(const details::log_msg &msg);
+    // msg.payload holds the captured arguments (see details::capture_deferred())
+    virtual void sink_deferred_(const details::log_msg &msg);
     virtual void flush_();
     void dump_backtrace_();
     bool should_flush_(const details::log_msg &msg);
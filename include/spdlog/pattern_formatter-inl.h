@@ -10,6 +10,7 @@
 #include <spdlog/details/fmt_helper.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/timestamp_cache.h>
 
 #ifndef SPDLOG_NO_TLS
     #include <spdlog/mdc.h>
@@ -39,64 +40,6 @@ namespace details {
 // name & level pattern appender
 ///////////////////////////////////////////////////////////////////////
 
-class scoped_padder {
-public:
-    scoped_padder(size_t wrapped_size, const padding_info &padinfo, memory_buf_t &dest)
-        : padinfo_(padinfo),
-          dest_(dest) {
-        remaining_pad_ = static_cast<long>(padinfo.width_) - static_cast<long>(wrapped_size);
-        if (remaining_pad_ <= 0) {
-            return;
-        }
-
-        if (padinfo_.side_ == padding_info::pad_side::left) {
-            pad_it(remaining_pad_);
-            remaining_pad_ = 0;
-        } else if (padinfo_.side_ == padding_info::pad_side::center) {
-            auto half_pad = remaining_pad_ / 2;
-            auto reminder = remaining_pad_ & 1;
-            pad_it(half_pad);
-            remaining_pad_ = half_pad + reminder;  // for the right side
-        }
-    }
-
-    template <typename T>
-    static unsigned int count_digits(T n) {
-        return fmt_helper::count_digits(n);
-    }
-
-    ~scoped_padder() {
-        if (remaining_pad_ >= 0) {
-            pad_it(remaining_pad_);
-        } else if (padinfo_.truncate_) {
-            long new_size = static_cast<long>(dest_.size()) + remaining_pad_;
-            dest_.resize(static_cast<size_t>(new_size));
-        }
-    }
-
-private:
-    void pad_it(long count) {
-        fmt_helper::append_string_view(string_view_t(spaces_.data(), static_cast<size_t>(count)),
-                                       dest_);
-    }
-
-    const padding_info &padinfo_;
-    memory_buf_t &dest_;
-    long remaining_pad_;
-    string_view_t spaces_{"                                                                ", 64};
-};
-
-struct null_scoped_padder {
-    null_scoped_padder(size_t /*wrapped_size*/,
-                       const padding_info & /*padinfo*/,
-                       memory_buf_t & /*dest*/) {}
-
-    template <typename T>
-    static unsigned int count_digits(T /* number */) {
-        return 0;
-    }
-};
-
 template <typename ScopedPadder>
 class name_formatter final : public flag_formatter {
 public:
@@ -510,18 +453,24 @@ public:
 template <typename ScopedPadder>
 class z_formatter final : public flag_formatter {
 public:
-    explicit z_formatter(padding_info padinfo)
-        : flag_formatter(padinfo) {}
+    z_formatter(padding_info padinfo, pattern_time_type time_type)
+        : flag_formatter(padinfo),
+          time_type_(time_type) {}
 
-    z_formatter() = default;
     z_formatter(const z_formatter &) = delete;
     z_formatter &operator=(const z_formatter &) = delete;
 
-    void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override {
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
         const size_t field_size = 6;
         ScopedPadder p(field_size, padinfo_, dest);
 
-        auto total_minutes = get_cached_offset(msg, tm_time);
+        // the offset of the shared timestamp of the second
+        auto secs =
+            std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+        if (!timestamp_ || timestamp_->secs != secs) {
+            timestamp_ = timestamp_cache::instance().get(msg.time, time_type_);
+        }
+        auto total_minutes = timestamp_->utc_offset_minutes;
         bool is_negative = total_minutes < 0;
         if (is_negative) {
             total_minutes = -total_minutes;
@@ -536,17 +485,8 @@ public:
     }
 
 private:
-    log_clock::time_point last_update_{std::chrono::seconds(0)};
-    int offset_minutes_{0};
-
-    int get_cached_offset(const log_msg &msg, const std::tm &tm_time) {
-        // refresh every 10 seconds
-        if (msg.time - last_update_ >= std::chrono::seconds(10)) {
-            offset_minutes_ = os::utc_minutes_offset(tm_time);
-            last_update_ = msg.time;
-        }
-        return offset_minutes_;
-    }
+    pattern_time_type time_type_;
+    std::shared_ptr<const timestamp> timestamp_;
 };
 
 // Thread id
@@ -835,39 +775,25 @@ public:
 // pattern: [%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v
 class full_formatter final : public flag_formatter {
 public:
-    explicit full_formatter(padding_info padinfo)
-        : flag_formatter(padinfo) {}
+    full_formatter(padding_info padinfo, pattern_time_type time_type)
+        : flag_formatter(padinfo),
+          time_type_(time_type) {}
 
-    void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override {
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
         using std::chrono::duration_cast;
         using std::chrono::milliseconds;
         using std::chrono::seconds;
 
-        // cache the date/time part for the next second.
+        // cache the date/time part for the next second, from the shared timestamp of the second.
         auto duration = msg.time.time_since_epoch();
         auto secs = duration_cast<seconds>(duration);
 
         if (cache_timestamp_ != secs || cached_datetime_.size() == 0) {
+            auto timestamp = timestamp_cache::instance().get(msg.time, time_type_);
             cached_datetime_.clear();
             cached_datetime_.push_back('[');
-            fmt_helper::append_int(tm_time.tm_year + 1900, cached_datetime_);
-            cached_datetime_.push_back('-');
-
-            fmt_helper::pad2(tm_time.tm_mon + 1, cached_datetime_);
-            cached_datetime_.push_back('-');
-
-            fmt_helper::pad2(tm_time.tm_mday, cached_datetime_);
-            cached_datetime_.push_back(' ');
-
-            fmt_helper::pad2(tm_time.tm_hour, cached_datetime_);
-            cached_datetime_.push_back(':');
-
-            fmt_helper::pad2(tm_time.tm_min, cached_datetime_);
-            cached_datetime_.push_back(':');
-
-            fmt_helper::pad2(tm_time.tm_sec, cached_datetime_);
+            fmt_helper::append_string_view(to_string_view(timestamp->datetime), cached_datetime_);
             cached_datetime_.push_back('.');
-
             cache_timestamp_ = secs;
         }
         dest.append(cached_datetime_.begin(), cached_datetime_.end());
@@ -922,6 +848,7 @@ public:
     }
 
 private:
+    pattern_time_type time_type_;
     std::chrono::seconds cache_timestamp_{0};
     memory_buf_t cached_datetime_;
 
@@ -931,6 +858,164 @@ private:
 
 };
 
+///////////////////////////////////////////////////////////////////////
+// compiled pattern
+///////////////////////////////////////////////////////////////////////
+
+// the byte code of a compiled pattern: an op byte, followed by its operands.
+// the flags that can be padded are followed by the padding (width byte, then side | truncate << 2)
+// when the op has the padded bit.
+namespace pattern_op {
+enum : uint8_t {
+    literal,       // size byte, then the chars
+    call,          // index in formatters_ (2 bytes, little endian)
+    time_segment,  // index in time_segments_ (2 bytes, little endian)
+    color_start,
+    color_stop,
+    name,
+    level,
+    short_level,
+    payload,
+    thread_id,
+    pid,
+    millis,
+    micros,
+    nanos,
+    // depend only on the time
+    year,
+    short_year,
+    month,
+    day,
+    hour,
+    minute,
+    second,
+    iso_time,
+    padded = 0x80
+};
+}  // namespace pattern_op
+
+// a flag or literal, before being encoded
+struct pattern_instr {
+    uint8_t op;
+    padding_info padding;
+    std::string literal;
+    size_t index;
+};
+
+// the op of the flags that the program renders itself, or -1
+static int flag_op(char flag) {
+    switch (flag) {
+        case 'n':
+            return pattern_op::name;
+        case 'l':
+            return pattern_op::level;
+        case 'L':
+            return pattern_op::short_level;
+        case 'v':
+            return pattern_op::payload;
+        case 't':
+            return pattern_op::thread_id;
+        case 'P':
+            return pattern_op::pid;
+        case 'e':
+            return pattern_op::millis;
+        case 'f':
+            return pattern_op::micros;
+        case 'F':
+            return pattern_op::nanos;
+        case 'Y':
+            return pattern_op::year;
+        case 'C':
+            return pattern_op::short_year;
+        case 'm':
+            return pattern_op::month;
+        case 'd':
+            return pattern_op::day;
+        case 'H':
+            return pattern_op::hour;
+        case 'M':
+            return pattern_op::minute;
+        case 'S':
+            return pattern_op::second;
+        case 'T':
+        case 'X':
+            return pattern_op::iso_time;
+        case '^':
+            return pattern_op::color_start;
+        case '$':
+            return pattern_op::color_stop;
+        default:
+            return -1;
+    }
+}
+
+static bool is_time_op(uint8_t op) { return op >= pattern_op::year && op <= pattern_op::iso_time; }
+
+static void encode_index(uint8_t op, size_t index, std::string &code) {
+    code.push_back(static_cast<char>(op));
+    code.push_back(static_cast<char>(index & 0xFF));
+    code.push_back(static_cast<char>((index >> 8) & 0xFF));
+}
+
+static void encode_instr(const pattern_instr &instr, std::string &code) {
+    switch (instr.op) {
+        case pattern_op::literal:
+            for (size_t pos = 0; pos < instr.literal.size(); pos += 255) {
+                auto size = (std::min)(instr.literal.size() - pos, size_t{255});
+                code.push_back(static_cast<char>(pattern_op::literal));
+                code.push_back(static_cast<char>(size));
+                code.append(instr.literal, pos, size);
+            }
+            break;
+        case pattern_op::call:
+        case pattern_op::time_segment:
+            encode_index(instr.op, instr.index, code);
+            break;
+        case pattern_op::color_start:
+        case pattern_op::color_stop:  // not padded
+            code.push_back(static_cast<char>(instr.op));
+            break;
+        default:
+            if (!instr.padding.enabled()) {
+                code.push_back(static_cast<char>(instr.op));
+                break;
+            }
+            code.push_back(static_cast<char>(instr.op | pattern_op::padded));
+            code.push_back(static_cast<char>(instr.padding.width_));
+            code.push_back(static_cast<char>(static_cast<int>(instr.padding.side_) |
+                                             (instr.padding.truncate_ ? 4 : 0)));
+            break;
+    }
+}
+
+static size_t decode_index(const char *pc) {
+    return static_cast<size_t>(static_cast<uint8_t>(pc[0])) |
+           static_cast<size_t>(static_cast<uint8_t>(pc[1])) << 8;
+}
+
+// pad (or truncate) the field rendered in dest from start, like scoped_padder
+static void pad_field(memory_buf_t &dest, size_t start, size_t width, uint8_t pad_flags) {
+    static const char spaces[] = "                                                                ";
+    auto size = dest.size() - start;
+    if (size > width) {
+        if (pad_flags & 4) {
+            dest.resize(start + width);
+        }
+        return;
+    }
+    auto pad = width - size;
+    auto side = static_cast<padding_info::pad_side>(pad_flags & 3);
+    size_t left_pad = side == padding_info::pad_side::left     ? pad
+                      : side == padding_info::pad_side::center ? pad / 2
+                                                               : 0;
+    if (left_pad > 0) {
+        dest.resize(dest.size() + left_pad);
+        std::memmove(dest.data() + start + left_pad, dest.data() + start, size);
+        std::memset(dest.data() + start, ' ', left_pad);
+    }
+    fmt_helper::append_string_view(string_view_t(spaces, pad - left_pad), dest);
+}
+
 }  // namespace details
 
 SPDLOG_INLINE pattern_formatter::pattern_formatter(std::string pattern,
@@ -955,7 +1040,10 @@ SPDLOG_INLINE pattern_formatter::pattern_formatter(pattern_time_type time_type,
       need_localtime_(true),
       last_log_secs_(0) {
     std::memset(&cached_tm_, 0, sizeof(cached_tm_));
-    formatters_.push_back(details::make_unique<details::full_formatter>(details::padding_info{}));
+    formatters_.push_back(
+        details::make_unique<details::full_formatter>(details::padding_info{}, time_type));
+    details::encode_index(details::pattern_op::call, 0, program_);
+    fused_ = fused_pattern::calls_only;
 }
 
 SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const {
@@ -977,19 +1065,37 @@ SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory
     if (need_localtime_) {
         const auto secs =
             std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
-        if (secs != last_log_secs_) {
-            cached_tm_ = get_time_(msg);
+        if (secs != last_log_secs_ || !timestamp_) {
+            timestamp_ = details::timestamp_cache::instance().get(msg.time, pattern_time_type_);
+            cached_tm_ = timestamp_->tm;
             last_log_secs_ = secs;
+            ++tm_generation_;
         }
     }
 
-    for (auto &f : formatters_) {
-        f->format(msg, cached_tm_, dest);
+    if (fused_ == fused_pattern::none) {
+        run_program_(program_.data(), program_.data() + program_.size(), msg, dest);
+    } else if (fused_ == fused_pattern::calls_only) {
+        for (auto &f : formatters_) {
+            f->format(msg, cached_tm_, dest);
+        }
+    } else {
+        format_fused_(msg, dest);
     }
     // write eol
     details::fmt_helper::append_string_view(eol_, dest);
 }
 
+SPDLOG_INLINE std::string pattern_formatter::format_key() const {
+    if (!custom_handlers_.empty()) {
+        return std::string{};
+    }
+    // the pattern size keeps the key unambiguous
+    return std::to_string(pattern_.size()) + ':' + pattern_ + ':' +
+           std::to_string(static_cast<int>(pattern_time_type_)) + ':' +
+           (need_localtime_ ? '1' : '0') + ':' + eol_;
+}
+
 SPDLOG_INLINE void pattern_formatter::set_pattern(std::string pattern) {
     pattern_ = std::move(pattern);
     need_localtime_ = false;
@@ -998,11 +1104,167 @@ SPDLOG_INLINE void pattern_formatter::set_pattern(std::string pattern) {
 
 SPDLOG_INLINE void pattern_formatter::need_localtime(bool need) { need_localtime_ = need; }
 
-SPDLOG_INLINE std::tm pattern_formatter::get_time_(const details::log_msg &msg) {
-    if (pattern_time_type_ == pattern_time_type::local) {
-        return details::os::localtime(log_clock::to_time_t(msg.time));
+SPDLOG_INLINE void pattern_formatter::run_program_(const char *pc,
+                                                   const char *end,
+                                                   const details::log_msg &msg,
+                                                   memory_buf_t &dest) {
+    using details::fmt_helper::append_int;
+    using details::fmt_helper::append_string_view;
+    using details::fmt_helper::pad2;
+    namespace op = details::pattern_op;
+
+    while (pc < end) {
+        auto code = static_cast<uint8_t>(*pc++);
+        size_t start = 0, width = 0;
+        uint8_t pad_flags = 0;
+        bool padded = (code & op::padded) != 0;
+        if (padded) {
+            code = static_cast<uint8_t>(code & ~op::padded);
+            width = static_cast<uint8_t>(pc[0]);
+            pad_flags = static_cast<uint8_t>(pc[1]);
+            pc += 2;
+            start = dest.size();
+        }
+        switch (code) {
+            case op::literal: {
+                auto size = static_cast<size_t>(static_cast<uint8_t>(*pc++));
+                append_string_view(string_view_t(pc, size), dest);
+                pc += size;
+                break;
+            }
+            case op::call:
+                formatters_[details::decode_index(pc)]->format(msg, cached_tm_, dest);
+                pc += 2;
+                break;
+            case op::time_segment: {
+                auto &segment = time_segments_[details::decode_index(pc)];
+                pc += 2;
+                if (segment.generation != tm_generation_) {
+                    segment.cached.clear();
+                    run_program_(segment.code.data(), segment.code.data() + segment.code.size(),
+                                 msg, segment.cached);
+                    segment.generation = tm_generation_;
+                }
+                append_string_view(string_view_t(segment.cached.data(), segment.cached.size()),
+                                   dest);
+                break;
+            }
+            case op::color_start:
+                msg.color_range_start = dest.size();
+                break;
+            case op::color_stop:
+                msg.color_range_end = dest.size();
+                break;
+            case op::name:
+                append_string_view(msg.logger_name, dest);
+                break;
+            case op::level:
+                append_string_view(level::to_string_view(msg.level), dest);
+                break;
+            case op::short_level:
+                append_string_view(level::to_short_c_str(msg.level), dest);
+                break;
+            case op::payload:
+                append_string_view(msg.payload, dest);
+                break;
+            case op::thread_id:
+                append_int(msg.thread_id, dest);
+                break;
+            case op::pid:
+                append_int(static_cast<uint32_t>(details::os::pid()), dest);
+                break;
+            case op::millis:
+                details::fmt_helper::pad3(
+                    static_cast<uint32_t>(
+                        details::fmt_helper::time_fraction<std::chrono::milliseconds>(msg.time)
+                            .count()),
+                    dest);
+                break;
+            case op::micros:
+                details::fmt_helper::pad6(
+                    static_cast<size_t>(
+                        details::fmt_helper::time_fraction<std::chrono::microseconds>(msg.time)
+                            .count()),
+                    dest);
+                break;
+            case op::nanos:
+                details::fmt_helper::pad9(
+                    static_cast<size_t>(
+                        details::fmt_helper::time_fraction<std::chrono::nanoseconds>(msg.time)
+                            .count()),
+                    dest);
+                break;
+            case op::year:
+                append_int(cached_tm_.tm_year + 1900, dest);
+                break;
+            case op::short_year:
+                pad2(cached_tm_.tm_year % 100, dest);
+                break;
+            case op::month:
+                pad2(cached_tm_.tm_mon + 1, dest);
+                break;
+            case op::day:
+                pad2(cached_tm_.tm_mday, dest);
+                break;
+            case op::hour:
+                pad2(cached_tm_.tm_hour, dest);
+                break;
+            case op::minute:
+                pad2(cached_tm_.tm_min, dest);
+                break;
+            case op::second:
+                pad2(cached_tm_.tm_sec, dest);
+                break;
+            case op::iso_time:
+                pad2(cached_tm_.tm_hour, dest);
+                dest.push_back(':');
+                pad2(cached_tm_.tm_min, dest);
+                dest.push_back(':');
+                pad2(cached_tm_.tm_sec, dest);
+                break;
+            default:
+                break;
+        }
+        if (padded) {
+            details::pad_field(dest, start, width, pad_flags);
+        }
     }
-    return details::os::gmtime(log_clock::to_time_t(msg.time));
+}
+
+// "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v", whose date time part is the first time segment
+SPDLOG_INLINE void pattern_formatter::format_fused_(const details::log_msg &msg,
+                                                    memory_buf_t &dest) {
+    using details::fmt_helper::append_string_view;
+
+    auto &segment = time_segments_[0];
+    if (segment.generation != tm_generation_) {
+        segment.cached.clear();
+        if (timestamp_) {
+            // the date time rendered by the shared timestamp
+            segment.cached.push_back('[');
+            append_string_view(details::to_string_view(timestamp_->datetime), segment.cached);
+            segment.cached.push_back('.');
+        } else {
+            run_program_(segment.code.data(), segment.code.data() + segment.code.size(), msg,
+                         segment.cached);
+        }
+        segment.generation = tm_generation_;
+    }
+    append_string_view(string_view_t(segment.cached.data(), segment.cached.size()), dest);
+    auto millis = details::fmt_helper::time_fraction<std::chrono::milliseconds>(msg.time);
+    details::fmt_helper::pad3(static_cast<uint32_t>(millis.count()), dest);
+    append_string_view(string_view_t("] [", 3), dest);
+    append_string_view(msg.logger_name, dest);
+    append_string_view(string_view_t("] [", 3), dest);
+    if (fused_ == fused_pattern::default_color_pattern) {
+        msg.color_range_start = dest.size();
+        append_string_view(level::to_string_view(msg.level), dest);
+        msg.color_range_end = dest.size();
+    } else {
+        append_string_view(level::to_string_view(msg.level), dest);
+    }
+    append_string_view(string_view_t("] ", 2), dest);
+    append_string_view(msg.payload, dest);
 }
 
 template <typename Padder>
@@ -1019,7 +1281,8 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
     // process built-in flags
     switch (flag) {
         case ('+'):  // default formatter
-            formatters_.push_back(details::make_unique<details::full_formatter>(padding));
+            formatters_.push_back(
+                details::make_unique<details::full_formatter>(padding, pattern_time_type_));
             need_localtime_ = true;
             break;
 
@@ -1154,7 +1417,8 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
             break;
 
         case ('z'):  // timezone
-            formatters_.push_back(details::make_unique<details::z_formatter<Padder>>(padding));
+            formatters_.push_back(
+                details::make_unique<details::z_formatter<Padder>>(padding, pattern_time_type_));
             need_localtime_ = true;
             break;
 
@@ -1300,39 +1564,106 @@ SPDLOG_INLINE details::padding_info pattern_formatter::handle_padspec_(
     return details::padding_info{std::min<size_t>(width, max_width), side, truncate};
 }
 
+// Compile the pattern to the program run by format():
+// the flags that the program renders itself become ops, the others are called from formatters_.
+// Then each run of flags that depend only on the time, with the literals around them, is fused in
+// a time segment, rendered once per second.
 SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &pattern) {
-    auto end = pattern.end();
-    std::unique_ptr<details::aggregate_formatter> user_chars;
+    namespace op = details::pattern_op;
+    using details::pattern_instr;
+
     formatters_.clear();
+    program_.clear();
+    time_segments_.clear();
+    fused_ = fused_pattern::none;
+
+    std::vector<pattern_instr> instrs;
+    std::string user_chars;
+    auto add_user_chars = [&] {
+        if (!user_chars.empty()) {
+            instrs.push_back(pattern_instr{op::literal, {}, std::move(user_chars), 0});
+            user_chars.clear();
+        }
+    };
+    auto end = pattern.end();
     for (auto it = pattern.begin(); it != end; ++it) {
-        if (*it == '%') {
-            if (user_chars)  // append user chars found so far
-            {
-                formatters_.push_back(std::move(user_chars));
-            }
+        if (*it != '%') {
+            // chars not following the % sign should be displayed as is
+            user_chars.push_back(*it);
+            continue;
+        }
+        auto padding = handle_padspec_(++it, end);
+        if (it == end) {
+            break;
+        }
+        auto flag = *it;
+        bool custom = custom_handlers_.find(flag) != custom_handlers_.end();
+        if (flag == '%' && !custom) {
+            user_chars.push_back('%');
+            continue;
+        }
+        add_user_chars();
+        auto inline_op = custom ? -1 : details::flag_op(flag);
+        if (inline_op >= 0) {
+            auto code = static_cast<uint8_t>(inline_op);
+            need_localtime_ = need_localtime_ || details::is_time_op(code);
+            instrs.push_back(pattern_instr{code, padding, std::string{}, 0});
+            continue;
+        }
+        auto first = formatters_.size();
+        if (padding.enabled()) {
+            handle_flag_<details::scoped_padder>(flag, padding);
+        } else {
+            handle_flag_<details::null_scoped_padder>(flag, padding);
+        }
+        for (auto i = first; i < formatters_.size(); i++) {
+            instrs.push_back(pattern_instr{op::call, {}, std::string{}, i});
+        }
+    }
+    add_user_chars();
 
-            auto padding = handle_padspec_(++it, end);
+    bool calls_only = true;
+    for (auto &instr : instrs) {
+        calls_only = calls_only && instr.op == op::call;
+    }
+    if (calls_only) {
+        // nothing to render in the program
+        for (auto &instr : instrs) {
+            details::encode_instr(instr, program_);
+        }
+        fused_ = fused_pattern::calls_only;
+        return;
+    }
 
-            if (it != end) {
-                if (padding.enabled()) {
-                    handle_flag_<details::scoped_padder>(*it, padding);
-                } else {
-                    handle_flag_<details::null_scoped_padder>(*it, padding);
-                }
-            } else {
+    for (size_t i = 0; i < instrs.size();) {
+        // the run of time flags and literals from i, if any
+        size_t run_end = i, time_ops = 0;
+        for (; run_end < instrs.size(); run_end++) {
+            auto code = instrs[run_end].op;
+            if (code != op::literal && !details::is_time_op(code)) {
                 break;
             }
-        } else  // chars not following the % sign should be displayed as is
-        {
-            if (!user_chars) {
-                user_chars = details::make_unique<details::aggregate_formatter>();
-            }
-            user_chars->add_ch(*it);
+            time_ops += details::is_time_op(code) ? 1 : 0;
         }
+        if (time_ops == 0 || run_end - i < 2) {
+            details::encode_instr(instrs[i], program_);
+            i++;
+            continue;
+        }
+        details::pattern_time_segment segment;
+        for (; i < run_end; i++) {
+            details::encode_instr(instrs[i], segment.code);
+        }
+        details::encode_index(op::time_segment, time_segments_.size(), program_);
+        time_segments_.push_back(std::move(segment));
     }
-    if (user_chars)  // append raw chars found so far
-    {
-        formatters_.push_back(std::move(user_chars));
+
+    if (custom_handlers_.empty()) {
+        if (pattern == "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v") {
+            fused_ = fused_pattern::default_pattern;
+        } else if (pattern == "[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v") {
+            fused_ = fused_pattern::default_color_pattern;
+        }
     }
 }
 }  // namespace spdlog
@@ -4,11 +4,14 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/timestamp_cache.h>
 #include <spdlog/formatter.h>
 
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <memory>
 
@@ -23,20 +26,79 @@ namespace details {
 struct padding_info {
     enum class pad_side { left, right, center };
 
-    padding_info() = default;
-    padding_info(size_t width, padding_info::pad_side side, bool truncate)
+    SPDLOG_CONSTEXPR padding_info() = default;
+    SPDLOG_CONSTEXPR padding_info(size_t width, padding_info::pad_side side, bool truncate)
         : width_(width),
           side_(side),
           truncate_(truncate),
           enabled_(true) {}
 
-    bool enabled() const { return enabled_; }
+    SPDLOG_CONSTEXPR bool enabled() const { return enabled_; }
     size_t width_ = 0;
     pad_side side_ = pad_side::left;
     bool truncate_ = false;
     bool enabled_ = false;
 };
 
+// pads (or truncates) to padinfo the field written during its lifetime, of wrapped_size chars
+class scoped_padder {
+public:
+    scoped_padder(size_t wrapped_size, const padding_info &padinfo, memory_buf_t &dest)
+        : padinfo_(padinfo),
+          dest_(dest) {
+        remaining_pad_ = static_cast<long>(padinfo.width_) - static_cast<long>(wrapped_size);
+        if (remaining_pad_ <= 0) {
+            return;
+        }
+
+        if (padinfo_.side_ == padding_info::pad_side::left) {
+            pad_it(remaining_pad_);
+            remaining_pad_ = 0;
+        } else if (padinfo_.side_ == padding_info::pad_side::center) {
+            auto half_pad = remaining_pad_ / 2;
+            auto reminder = remaining_pad_ & 1;
+            pad_it(half_pad);
+            remaining_pad_ = half_pad + reminder;  // for the right side
+        }
+    }
+
+    template <typename T>
+    static unsigned int count_digits(T n) {
+        return fmt_helper::count_digits(n);
+    }
+
+    ~scoped_padder() {
+        if (remaining_pad_ >= 0) {
+            pad_it(remaining_pad_);
+        } else if (padinfo_.truncate_) {
+            long new_size = static_cast<long>(dest_.size()) + remaining_pad_;
+            dest_.resize(static_cast<size_t>(new_size));
+        }
+    }
+
+private:
+    void pad_it(long count) {
+        fmt_helper::append_string_view(string_view_t(spaces_.data(), static_cast<size_t>(count)),
+                                       dest_);
+    }
+
+    const padding_info &padinfo_;
+    memory_buf_t &dest_;
+    long remaining_pad_;
+    string_view_t spaces_{"                                                                ", 64};
+};
+
+struct null_scoped_padder {
+    null_scoped_padder(size_t /*wrapped_size*/,
+                       const padding_info & /*padinfo*/,
+                       memory_buf_t & /*dest*/) {}
+
+    template <typename T>
+    static unsigned int count_digits(T /* number */) {
+        return 0;
+    }
+};
+
 class SPDLOG_API flag_formatter {
 public:
     explicit flag_formatter(padding_info padinfo)
@@ -51,6 +113,14 @@ protected:
     padding_info padinfo_;
 };
 
+// a run of flags that depend only on the time, with the literals between them (e.g. the
+// "[%Y-%m-%d %H:%M:%S." of a pattern), rendered once per second by pattern_formatter.
+struct pattern_time_segment {
+    std::string code;  // the program of the run
+    memory_buf_t cached;
+    uint64_t generation = 0;  // of the cached tm it was rendered from
+};
+
 }  // namespace details
 
 class SPDLOG_API custom_flag_formatter : public details::flag_formatter {
@@ -80,6 +150,9 @@ public:
 
     std::unique_ptr<formatter> clone() const override;
     void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    // pattern, time type, need_localtime and eol. empty with custom flags, which may format
+    // differently.
+    std::string format_key() const override;
 
     template <typename T, typename... Args>
     pattern_formatter &add_flag(char flag, Args &&...args) {
@@ -95,14 +168,30 @@ private:
     pattern_time_type pattern_time_type_;
     bool need_localtime_;
     std::tm cached_tm_;
+    std::shared_ptr<const details::timestamp> timestamp_;  // of cached_tm_, shared process-wide
     std::chrono::seconds last_log_secs_;
+    uint64_t tm_generation_ = 1;  // incremented when cached_tm_ changes
+    // the compiled pattern: a byte code run by format() (see compile_pattern_()).
+    // the flags that it doesn't render itself (custom, stateful or rare ones) are called from
+    // formatters_.
+    std::string program_;
+    std::vector<details::pattern_time_segment> time_segments_;
+    // hand-fused routine for the pattern "[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v",
+    // and with "[%^%l%$]". calls_only: the program only calls formatters_ (e.g. "%+").
+    enum class fused_pattern { none, calls_only, default_pattern, default_color_pattern };
+    fused_pattern fused_ = fused_pattern::none;
     std::vector<std::unique_ptr<details::flag_formatter>> formatters_;
     custom_flags custom_handlers_;
 
-    std::tm get_time_(const details::log_msg &msg);
     template <typename Padder>
     void handle_flag_(char flag, details::padding_info padding);
 
+    void run_program_(const char *pc,
+                      const char *end,
+                      const details::log_msg &msg,
+                      memory_buf_t &dest);
+    void format_fused_(const details::log_msg &msg, memory_buf_t &dest);
+
     // Extract given pad spec (e.g. %8X)
     // Advance the given it pass the end of the padding spec found (if any)
     // Return padding.
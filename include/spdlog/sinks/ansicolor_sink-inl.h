@@ -42,19 +42,45 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log(const details::log_msg &msg
     // Wrap the originally formatted message in color codes.
     // If color is not supported in the terminal, log as is instead.
     std::lock_guard<mutex_t> lock(mutex_);
+    log_(msg);
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_shared(const details::log_msg &msg,
+                                                            shared_format &shared) {
+    std::lock_guard<mutex_t> lock(mutex_);
+    const details::log_msg *msgs[] = {&msg};
+    if (format_sharing_.format(*formatter_, msgs, 1, shared)) {
+        print_(msg.level, shared.line(0), shared.color_range_start, shared.color_range_end);
+    } else {
+        log_(msg);
+    }
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_(const details::log_msg &msg) {
     msg.color_range_start = 0;
     msg.color_range_end = 0;
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
-    if (should_do_colors_ && msg.color_range_end > msg.color_range_start) {
+    print_(msg.level, string_view_t(formatted.data(), formatted.size()), msg.color_range_start,
+           msg.color_range_end);
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_(level::level_enum lvl,
+                                                        string_view_t formatted,
+                                                        size_t color_range_start,
+                                                        size_t color_range_end) {
+    if (should_do_colors_ && color_range_end > color_range_start) {
         // before color range
-        print_range_(formatted, 0, msg.color_range_start);
+        print_range_(formatted, 0, color_range_start);
         // in color range
-        print_ccode_(colors_.at(static_cast<size_t>(msg.level)));
-        print_range_(formatted, msg.color_range_start, msg.color_range_end);
+        print_ccode_(colors_.at(static_cast<size_t>(lvl)));
+        print_range_(formatted, color_range_start, color_range_end);
         print_ccode_(reset);
         // after color range
-        print_range_(formatted, msg.color_range_end, formatted.size());
+        print_range_(formatted, color_range_end, formatted.size());
     } else  // no color
     {
         print_range_(formatted, 0, formatted.size());
@@ -72,6 +98,7 @@ template <typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_pattern(const std::string &pattern) {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    format_sharing_.reset();
 }
 
 template <typename ConsoleMutex>
@@ -79,6 +106,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_formatter(
     std::unique_ptr<spdlog::formatter> sink_formatter) {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::move(sink_formatter);
+    format_sharing_.reset();
 }
 
 template <typename ConsoleMutex>
@@ -110,7 +138,7 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_ccode_(const string_view_
 }
 
 template <typename ConsoleMutex>
-SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_range_(const memory_buf_t &formatted,
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_range_(string_view_t formatted,
                                                               size_t start,
                                                               size_t end) {
     details::os::fwrite_bytes(formatted.data() + start, end - start, target_file_);
@@ -39,6 +39,7 @@ public:
     bool should_color();
 
     void log(const details::log_msg &msg) override;
+    void log_shared(const details::log_msg &msg, shared_format &shared) override;
     void flush() override;
     void set_pattern(const std::string &pattern) final override;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
@@ -84,8 +85,15 @@ private:
     bool should_do_colors_;
     std::unique_ptr<spdlog::formatter> formatter_;
     std::array<std::string, level::n_levels> colors_;
+    format_sharing format_sharing_;
+    // format and print msg, under the lock
+    void log_(const details::log_msg &msg);
+    void print_(level::level_enum lvl,
+                string_view_t formatted,
+                size_t color_range_start,
+                size_t color_range_end);
     void print_ccode_(const string_view_t &color_code);
-    void print_range_(const memory_buf_t &formatted, size_t start, size_t end);
+    void print_range_(string_view_t formatted, size_t start, size_t end);
     static std::string to_string_(const string_view_t &sv);
 };
 
@@ -28,6 +28,36 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &
     sink_it_(msg);
 }
 
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(const details::log_msg *const *msgs,
+                                                              size_t count) {
+    std::lock_guard<Mutex> lock(mutex_);
+    sink_batch_(msgs, count);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_shared(const details::log_msg &msg,
+                                                               shared_format &shared) {
+    std::lock_guard<Mutex> lock(mutex_);
+    const details::log_msg *msgs[] = {&msg};
+    if (accepts_formatted_() && format_sharing_.format(*formatter_, msgs, 1, shared)) {
+        sink_formatted_(msg, shared.line(0));
+    } else {
+        sink_it_(msg);
+    }
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch_shared(
+    const details::log_msg *const *msgs, size_t count, shared_format &shared) {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (accepts_formatted_() && format_sharing_.format(*formatter_, msgs, count, shared)) {
+        sink_formatted_batch_(msgs, count, shared);
+    } else {
+        sink_batch_(msgs, count);
+    }
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush() {
     std::lock_guard<Mutex> lock(mutex_);
@@ -38,6 +68,7 @@ template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern(const std::string &pattern) {
     std::lock_guard<Mutex> lock(mutex_);
     set_pattern_(pattern);
+    format_sharing_.reset();
 }
 
 template <typename Mutex>
@@ -45,6 +76,34 @@ void SPDLOG_INLINE
 spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
     std::lock_guard<Mutex> lock(mutex_);
     set_formatter_(std::move(sink_formatter));
+    format_sharing_.reset();
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                                size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sink_it_(*msgs[i]);
+    }
+}
+
+template <typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::accepts_formatted_() const {
+    return false;
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg,
+                                                                    string_view_t) {
+    sink_it_(msg);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_batch_(
+    const details::log_msg *const *msgs, size_t count, const shared_format &shared) {
+    for (size_t i = 0; i < count; i++) {
+        sink_formatted_(*msgs[i], shared.line(i));
+    }
 }
 
 template <typename Mutex>
@@ -29,6 +29,11 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final override;
+    void log_batch(const details::log_msg *const *msgs, size_t count) final override;
+    void log_shared(const details::log_msg &msg, shared_format &shared) final override;
+    void log_batch_shared(const details::log_msg *const *msgs,
+                          size_t count,
+                          shared_format &shared) final override;
     void flush() final override;
     void set_pattern(const std::string &pattern) final override;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final override;
@@ -39,9 +44,23 @@ protected:
     Mutex mutex_;
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // called by log_batch() under the sink's lock. calls sink_it_() for each message by default.
+    virtual void sink_batch_(const details::log_msg *const *msgs, size_t count);
+    // the sinks that can write messages formatted by another sink with an equivalent formatter
+    // (see log_shared()) return true, and override sink_formatted_().
+    virtual bool accepts_formatted_() const;
+    // write a message already formatted. calls sink_it_() by default.
+    virtual void sink_formatted_(const details::log_msg &msg, string_view_t formatted);
+    // calls sink_formatted_() for each message by default.
+    virtual void sink_formatted_batch_(const details::log_msg *const *msgs,
+                                       size_t count,
+                                       const shared_format &shared);
     virtual void flush_() = 0;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
+
+private:
+    format_sharing format_sharing_;
 };
 }  // namespace sinks
 }  // namespace spdlog
@@ -16,8 +16,11 @@ namespace sinks {
 template <typename Mutex>
 SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename,
                                                       bool truncate,
-                                                      const file_event_handlers &event_handlers)
+                                                      const file_event_handlers &event_handlers,
+                                                      const file_sink_options &options)
     : file_helper_{event_handlers} {
+    file_helper_.set_write_buffer_size(options.write_buffer_size);
+    file_helper_.set_compression(options.compress);
     file_helper_.open(filename, truncate);
 }
 
@@ -39,6 +42,36 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
     file_helper_.write(formatted);
 }
 
+// format the whole batch and write it to the file at once
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                       size_t count) {
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++) {
+        base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+    }
+    file_helper_.write(formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE bool basic_file_sink<Mutex>::accepts_formatted_() const {
+    return true;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                           string_view_t formatted) {
+    file_helper_.write(formatted);
+}
+
+// the messages of the batch are one after the other: write them at once
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_batch_(const details::log_msg *const *,
+                                                                 size_t,
+                                                                 const shared_format &shared) {
+    file_helper_.write(shared.formatted);
+}
+
 template <typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::flush_() {
     file_helper_.flush();
@@ -14,19 +14,27 @@
 namespace spdlog {
 namespace sinks {
 /*
- * Trivial file sink with single file as target
+ * Trivial file sink with single file as target.
+ * See file_sink_options for the write buffer and the compression.
  */
 template <typename Mutex>
 class basic_file_sink final : public base_sink<Mutex> {
 public:
     explicit basic_file_sink(const filename_t &filename,
                              bool truncate = false,
-                             const file_event_handlers &event_handlers = {});
+                             const file_event_handlers &event_handlers = {},
+                             const file_sink_options &options = {});
     const filename_t &filename() const;
     void truncate();
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void sink_formatted_batch_(const details::log_msg *const *msgs,
+                               size_t count,
+                               const shared_format &shared) override;
     void flush_() override;
 
 private:
@@ -45,18 +53,20 @@ template <typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> basic_logger_mt(const std::string &logger_name,
                                                const filename_t &filename,
                                                bool truncate = false,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_event_handlers &event_handlers = {},
+                                               const file_sink_options &options = {}) {
     return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate,
-                                                               event_handlers);
+                                                               event_handlers, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> basic_logger_st(const std::string &logger_name,
                                                const filename_t &filename,
                                                bool truncate = false,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_event_handlers &event_handlers = {},
+                                               const file_sink_options &options = {}) {
     return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate,
-                                                               event_handlers);
+                                                               event_handlers, options);
 }
 
 }  // namespace spdlog
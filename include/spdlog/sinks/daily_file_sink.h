@@ -4,8 +4,10 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/circular_q.h>
 #include <spdlog/details/file_helper.h>
+#include <spdlog/details/lz4_frame.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/os.h>
 #include <spdlog/details/synchronous_factory.h>
@@ -16,6 +18,7 @@
 #include <chrono>
 #include <cstdio>
 #include <iomanip>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -64,6 +67,9 @@ struct daily_filename_format_calculator {
  * If max_files > 0, retain only the last max_files and delete previous.
  * Note that old log files from previous executions will not be deleted by this class,
  * rotation and deletion is only applied while the program is running.
+ * See file_sink_options for the write buffer and the compression. With options.compress_rotated,
+ * the old files are deleted on the background thread too. A failure there is thrown at the next
+ * rotation.
  */
 template <typename Mutex, typename FileNameCalc = daily_filename_calculator>
 class daily_file_sink final : public base_sink<Mutex> {
@@ -74,7 +80,8 @@ public:
                     int rotation_minute,
                     bool truncate = false,
                     uint16_t max_files = 0,
-                    const file_event_handlers &event_handlers = {})
+                    const file_event_handlers &event_handlers = {},
+                    const file_sink_options &options = {})
         : base_filename_(std::move(base_filename)),
           rotation_h_(rotation_hour),
           rotation_m_(rotation_minute),
@@ -86,6 +93,11 @@ public:
             rotation_minute > 59) {
             throw_spdlog_ex("daily_file_sink: Invalid rotation time in ctor");
         }
+        if (options.compress_rotated) {
+            worker_ = details::make_unique<details::background_worker>();
+        }
+        file_helper_.set_write_buffer_size(options.write_buffer_size);
+        file_helper_.set_compression(options.compress);
 
         auto now = log_clock::now();
         auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
@@ -104,15 +116,25 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(time));
+            auto closed_filename = file_helper_.filename();
             file_helper_.open(filename, truncate_);
             rotation_tp_ = next_rotation_tp_();
+            if (worker_ && closed_filename != filename) {
+                compress_(closed_filename);
+            }
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -124,6 +146,23 @@ protected:
     void flush_() override { file_helper_.flush(); }
 
 private:
+    static filename_t compressed_filename_(const filename_t &filename) {
+        return filename + SPDLOG_FILENAME_T(".lz4");
+    }
+
+    // compress the closed file in the background, and track the compressed name
+    void compress_(const filename_t &filename) {
+        // the files written compressed are already compressed
+        if (file_helper_.compressed()) {
+            return;
+        }
+        auto compressed = compressed_filename_(filename);
+        if (max_files_ > 0 && !filenames_q_.empty() && filenames_q_.back() == filename) {
+            filenames_q_.back() = compressed;
+        }
+        worker_->post([filename, compressed] { details::lz4_compress_file(filename, compressed); });
+    }
+
     void init_filenames_q_() {
         using details::os::path_exists;
 
@@ -133,7 +172,10 @@ private:
         while (filenames.size() < max_files_) {
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
             if (!path_exists(filename)) {
-                break;
+                if (!worker_ || !path_exists(compressed_filename_(filename))) {
+                    break;
+                }
+                filename = compressed_filename_(filename);
             }
             filenames.emplace_back(filename);
             now -= std::chrono::hours(24);
@@ -168,6 +210,22 @@ private:
         using details::os::remove_if_exists;
 
         filename_t current_file = file_helper_.filename();
+        if (worker_) {
+            // after its compression, in the background
+            if (filenames_q_.full()) {
+                auto old_filename = std::move(filenames_q_.front());
+                filenames_q_.pop_front();
+                worker_->post([old_filename] {
+                    if (remove_if_exists(old_filename) != 0) {
+                        throw_spdlog_ex(
+                            "Failed removing daily file " + filename_to_str(old_filename), errno);
+                    }
+                });
+            }
+            filenames_q_.push_back(std::move(current_file));
+            worker_->rethrow_error();
+            return;
+        }
         if (filenames_q_.full()) {
             auto old_filename = std::move(filenames_q_.front());
             filenames_q_.pop_front();
@@ -189,6 +247,7 @@ private:
     bool truncate_;
     uint16_t max_files_;
     details::circular_q<filename_t> filenames_q_;
+    std::unique_ptr<details::background_worker> worker_;
 };
 
 using daily_file_sink_mt = daily_file_sink<std::mutex>;
@@ -209,9 +268,10 @@ inline std::shared_ptr<logger> daily_logger_mt(const std::string &logger_name,
                                                int minute = 0,
                                                bool truncate = false,
                                                uint16_t max_files = 0,
-                                               const file_event_handlers &event_handlers = {}) {
-    return Factory::template create<sinks::daily_file_sink_mt>(logger_name, filename, hour, minute,
-                                                               truncate, max_files, event_handlers);
+                                               const file_event_handlers &event_handlers = {},
+                                               const file_sink_options &options = {}) {
+    return Factory::template create<sinks::daily_file_sink_mt>(
+        logger_name, filename, hour, minute, truncate, max_files, event_handlers, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -222,9 +282,10 @@ inline std::shared_ptr<logger> daily_logger_format_mt(
     int minute = 0,
     bool truncate = false,
     uint16_t max_files = 0,
-    const file_event_handlers &event_handlers = {}) {
+    const file_event_handlers &event_handlers = {},
+    const file_sink_options &options = {}) {
     return Factory::template create<sinks::daily_file_format_sink_mt>(
-        logger_name, filename, hour, minute, truncate, max_files, event_handlers);
+        logger_name, filename, hour, minute, truncate, max_files, event_handlers, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -234,9 +295,10 @@ inline std::shared_ptr<logger> daily_logger_st(const std::string &logger_name,
                                                int minute = 0,
                                                bool truncate = false,
                                                uint16_t max_files = 0,
-                                               const file_event_handlers &event_handlers = {}) {
-    return Factory::template create<sinks::daily_file_sink_st>(logger_name, filename, hour, minute,
-                                                               truncate, max_files, event_handlers);
+                                               const file_event_handlers &event_handlers = {},
+                                               const file_sink_options &options = {}) {
+    return Factory::template create<sinks::daily_file_sink_st>(
+        logger_name, filename, hour, minute, truncate, max_files, event_handlers, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -247,8 +309,9 @@ inline std::shared_ptr<logger> daily_logger_format_st(
     int minute = 0,
     bool truncate = false,
     uint16_t max_files = 0,
-    const file_event_handlers &event_handlers = {}) {
+    const file_event_handlers &event_handlers = {},
+    const file_sink_options &options = {}) {
     return Factory::template create<sinks::daily_file_format_sink_st>(
-        logger_name, filename, hour, minute, truncate, max_files, event_handlers);
+        logger_name, filename, hour, minute, truncate, max_files, event_handlers, options);
 }
 }  // namespace spdlog
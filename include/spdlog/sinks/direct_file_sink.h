@@ -0,0 +1,99 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/direct_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <mutex>
+#include <string>
+
+// File sink for linux that writes with O_DIRECT (see details::direct_file), so the log doesn't
+// fill the page cache. The formatted lines are gathered in an aligned buffer of buffer_size bytes,
+// written when full. Each flush writes the partial block at the end of the file again, so flushing
+// often (e.g. flush_on(level::info)) costs a block write per flush.
+
+namespace spdlog {
+namespace sinks {
+
+template <typename Mutex>
+class direct_file_sink final : public base_sink<Mutex> {
+public:
+    explicit direct_file_sink(const filename_t &filename,
+                              bool truncate = false,
+                              size_t buffer_size = 1024 * 1024)
+        : file_{buffer_size} {
+        file_.open(filename, truncate);
+    }
+
+    const filename_t &filename() const { return file_.filename(); }
+
+    // false if the file system doesn't support O_DIRECT, and the file is written through the
+    // page cache
+    bool direct() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_.direct();
+    }
+
+    // flush and fdatasync
+    void sync() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        file_.sync();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        file_.write(string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &, string_view_t formatted) override {
+        file_.write(formatted);
+    }
+
+    void sink_formatted_batch_(const details::log_msg *const *,
+                               size_t,
+                               const shared_format &shared) override {
+        file_.write(string_view_t(shared.formatted.data(), shared.formatted.size()));
+    }
+
+    void flush_() override { file_.flush(); }
+
+private:
+    details::direct_file file_;
+};
+
+using direct_file_sink_mt = direct_file_sink<std::mutex>;
+using direct_file_sink_st = direct_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> direct_file_logger_mt(const std::string &logger_name,
+                                                     const filename_t &filename,
+                                                     bool truncate = false,
+                                                     size_t buffer_size = 1024 * 1024) {
+    return Factory::template create<sinks::direct_file_sink_mt>(logger_name, filename, truncate,
+                                                                buffer_size);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> direct_file_logger_st(const std::string &logger_name,
+                                                     const filename_t &filename,
+                                                     bool truncate = false,
+                                                     size_t buffer_size = 1024 * 1024) {
+    return Factory::template create<sinks::direct_file_sink_st>(logger_name, filename, truncate,
+                                                                buffer_size);
+}
+
+}  // namespace spdlog
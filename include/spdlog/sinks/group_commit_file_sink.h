@@ -0,0 +1,190 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/sink.h>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// File sink with durable logging by group commit.
+// The messages with a level >= durable_level are durable: logging them returns once they are on
+// disk. Instead of an fdatasync per message, the first waiting thread becomes the leader of a
+// group: it waits for commit_window, so the other threads append their messages, then flushes the
+// file and syncs it once, outside of the lock, for every message written until then. The messages
+// logged during this sync are covered by the next one. The other messages are written as usual.
+// wait_durable() waits until everything logged so far is on disk.
+
+namespace spdlog {
+namespace sinks {
+
+struct group_commit_config {
+    level::level_enum durable_level = level::trace;  // level::off: none is durable
+    std::chrono::microseconds commit_window{0};      // 0: sync as soon as the last sync is done
+};
+
+class group_commit_file_sink final : public sink {
+public:
+    explicit group_commit_file_sink(const filename_t &filename,
+                                    bool truncate = false,
+                                    const group_commit_config &config = {},
+                                    const file_event_handlers &event_handlers = {})
+        : config_{config},
+          formatter_{details::make_unique<spdlog::pattern_formatter>()},
+          file_helper_{event_handlers} {
+        file_helper_.open(filename, truncate);
+    }
+
+    group_commit_file_sink(const group_commit_file_sink &) = delete;
+    group_commit_file_sink &operator=(const group_commit_file_sink &) = delete;
+
+    void log(const details::log_msg &msg) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        write_(msg);
+        if (durable_(msg)) {
+            wait_synced_(lock, written_);
+        }
+    }
+
+    void log_batch(const details::log_msg *const *msgs, size_t count) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool durable = false;
+        for (size_t i = 0; i < count; i++) {
+            write_(*msgs[i]);
+            durable = durable || durable_(*msgs[i]);
+        }
+        if (durable) {
+            wait_synced_(lock, written_);
+        }
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_helper_.flush();
+    }
+
+    void set_pattern(const std::string &pattern) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        formatter_ = details::make_unique<spdlog::pattern_formatter>(pattern);
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        formatter_ = std::move(sink_formatter);
+    }
+
+    // wait until every message logged so far is on disk
+    void wait_durable() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wait_synced_(lock, written_);
+    }
+
+    const filename_t &filename() const { return file_helper_.filename(); }
+
+    // number of fdatasync done
+    uint64_t sync_count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sync_count_;
+    }
+
+private:
+    group_commit_config config_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    details::file_helper file_helper_;
+    std::mutex mutex_;
+    std::condition_variable synced_cv_;
+    uint64_t written_ = 0;  // sequence number of the last message written
+    uint64_t synced_ = 0;   // sequence number of the last message on disk
+    bool syncing_ = false;  // a leader is syncing
+    uint64_t sync_count_ = 0;
+
+    bool durable_(const details::log_msg &msg) const {
+        return msg.level >= config_.durable_level && msg.level != level::off;
+    }
+
+    void write_(const details::log_msg &msg) {
+        memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+        file_helper_.write(formatted);
+        ++written_;
+    }
+
+    // wait until the message seq is synced, syncing as the leader if no one does
+    void wait_synced_(std::unique_lock<std::mutex> &lock, uint64_t seq) {
+        while (synced_ < seq) {
+            if (syncing_) {
+                synced_cv_.wait(lock);
+            } else {
+                commit_(lock);
+            }
+        }
+    }
+
+    void commit_(std::unique_lock<std::mutex> &lock) {
+        syncing_ = true;
+        if (config_.commit_window.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(config_.commit_window);
+            lock.lock();
+        }
+        auto target = written_;
+        bool ok = false;
+        int err = 0;
+        {
+            // however this ends, wake up the waiters: on failure, one of them retries as leader
+            sync_end end{*this};
+            file_helper_.flush();
+            std::FILE *fd = file_helper_.handle();
+            // the writers go on while syncing
+            lock.unlock();
+            ok = details::os::fdatasync(fd);
+            err = errno;
+            lock.lock();
+            if (ok) {
+                synced_ = target;
+                ++sync_count_;
+            }
+        }
+        if (!ok) {
+            throw_spdlog_ex("Failed to fdatasync file " + details::os::filename_to_str(filename()),
+                            err);
+        }
+    }
+
+    struct sync_end {
+        group_commit_file_sink &owner;
+        ~sync_end() {
+            owner.syncing_ = false;
+            owner.synced_cv_.notify_all();
+        }
+    };
+};
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> group_commit_logger_mt(
+    const std::string &logger_name,
+    const filename_t &filename,
+    bool truncate = false,
+    const sinks::group_commit_config &config = {}) {
+    return Factory::template create<sinks::group_commit_file_sink>(logger_name, filename, truncate,
+                                                                   config);
+}
+
+}  // namespace spdlog
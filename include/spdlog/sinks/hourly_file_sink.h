@@ -73,6 +73,14 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
@@ -85,8 +93,6 @@ protected:
             rotation_tp_ = next_rotation_tp_();
         }
         remove_init_file_ = false;
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
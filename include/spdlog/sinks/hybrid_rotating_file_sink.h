@@ -0,0 +1,244 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/circular_q.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/daily_file_sink.h>
+
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace spdlog {
+namespace sinks {
+
+/*
+ * Rotating file sink based on size and time, whichever comes first.
+ * The time is divided in periods of rotation_interval from the local midnight (e.g. 60 minutes for
+ * hourly files, 1440 for daily ones), each with its own file named by FileNameCalc from the start
+ * of the period, which must tell the periods of a day apart (e.g. hourly_filename_calculator for
+ * hourly files). When a file exceeds max_size within a period, the next one gets the next index:
+ * log_2024-01-01.txt, log_2024-01-01.1.txt, log_2024-01-01.2.txt ... No file is renamed.
+ * The end of the period is computed when opening a file, so checking the time takes one comparison
+ * with the time of the message. A message older than the period doesn't rotate.
+ * If max_files > 0, retain only the last max_files and delete previous.
+ * Note that old log files from previous executions will not be deleted by this class.
+ * The periods are counted from midnight in seconds, so on the days of a DST change, their local
+ * times are shifted by the change.
+ */
+template <typename Mutex, typename FileNameCalc = daily_filename_calculator>
+class hybrid_rotating_file_sink final : public base_sink<Mutex> {
+public:
+    hybrid_rotating_file_sink(filename_t base_filename,
+                              std::size_t max_size,
+                              std::chrono::minutes rotation_interval = std::chrono::hours(24),
+                              uint16_t max_files = 0,
+                              const file_event_handlers &event_handlers = {})
+        : base_filename_(std::move(base_filename)),
+          max_size_(max_size),
+          rotation_interval_(rotation_interval),
+          file_helper_{event_handlers},
+          max_files_(max_files),
+          filenames_q_() {
+        if (max_size == 0) {
+            throw_spdlog_ex("hybrid rotating sink constructor: max_size arg cannot be zero");
+        }
+        if (rotation_interval.count() <= 0 ||
+            std::chrono::minutes(std::chrono::hours(24)).count() % rotation_interval.count() != 0) {
+            throw_spdlog_ex(
+                "hybrid rotating sink constructor: rotation_interval must divide 24 hours");
+        }
+        check_filenames_();
+        open_period_(log_clock::now());
+        if (max_files_ > 0) {
+            filenames_q_ = details::circular_q<filename_t>(static_cast<size_t>(max_files_));
+            filenames_q_.push_back(filename_t(file_helper_.filename()));
+        }
+    }
+
+    // calc filename of the given index within the period of the given start time.
+    // e.g. calc_filename("logs/mylog.txt", tm, 3) => "logs/mylog_2024-01-01.3.txt".
+    static filename_t calc_filename(const filename_t &filename, const tm &period_tm,
+                                    std::size_t index) {
+        auto period_filename = FileNameCalc::calc_filename(filename, period_tm);
+        if (index == 0u) {
+            return period_filename;
+        }
+        filename_t basename, ext;
+        std::tie(basename, ext) = details::file_helper::split_by_extension(period_filename);
+        return fmt_lib::format(SPDLOG_FMT_STRING(SPDLOG_FILENAME_T("{}.{}{}")), basename, index,
+                               ext);
+    }
+
+    filename_t filename() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.filename();
+    }
+
+    // the end of the current period
+    log_clock::time_point next_rotation_time() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return rotation_tp_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override {
+        bool rotated = false;
+        if (msg.time >= rotation_tp_) {
+            open_period_(msg.time);
+            rotated = true;
+        } else if (current_size_ + formatted.size() > max_size_) {
+            // rotate only if the real size > 0 to better deal with full disk (see issue #2261).
+            file_helper_.flush();
+            if (file_helper_.size() > 0) {
+                open_index_(free_index_(index_ + 1));
+                rotated = true;
+            }
+        }
+        file_helper_.write(formatted);
+        current_size_ += formatted.size();
+
+        // Do the cleaning only at the end because it might throw on failure.
+        if (rotated && max_files_ > 0) {
+            delete_old_();
+        }
+    }
+
+    void flush_() override { file_helper_.flush(); }
+
+private:
+    // open the file of the period of tp, and compute the end of the period.
+    void open_period_(log_clock::time_point tp) {
+        tm date = details::os::localtime(log_clock::to_time_t(tp));
+        date.tm_hour = 0;
+        date.tm_min = 0;
+        date.tm_sec = 0;
+        date.tm_isdst = -1;
+        auto midnight = log_clock::from_time_t(std::mktime(&date));
+        auto periods = std::chrono::duration_cast<std::chrono::minutes>(tp - midnight).count() /
+                       rotation_interval_.count();
+        auto period_start = midnight + rotation_interval_ * periods;
+        rotation_tp_ = period_start + rotation_interval_;
+        period_tm_ = details::os::localtime(log_clock::to_time_t(period_start));
+        // append to the last file of the period, if any (e.g. after a restart)
+        auto index = free_index_(0);
+        open_index_(index > 0 ? index - 1 : 0);
+    }
+
+    // open the file of the given index in the current period
+    void open_index_(std::size_t index) {
+        index_ = index;
+        file_helper_.open(calc_filename(base_filename_, period_tm_, index_));
+        current_size_ = file_helper_.size();  // expensive. called only on rotation
+    }
+
+    // the first index of the current period from index whose file doesn't exist
+    std::size_t free_index_(std::size_t index) const {
+        while (details::os::path_exists(calc_filename(base_filename_, period_tm_, index))) {
+            index++;
+        }
+        return index;
+    }
+
+    // throw if the first two periods of the day get the same filename
+    void check_filenames_() const {
+        if (rotation_interval_ >= std::chrono::hours(24)) {
+            return;
+        }
+        tm date{};
+        date.tm_year = 100;
+        date.tm_mday = 1;
+        tm next = date;
+        next.tm_hour = static_cast<int>(rotation_interval_.count() / 60);
+        next.tm_min = static_cast<int>(rotation_interval_.count() % 60);
+        if (FileNameCalc::calc_filename(base_filename_, date) ==
+            FileNameCalc::calc_filename(base_filename_, next)) {
+            throw_spdlog_ex(
+                "hybrid rotating sink constructor: the filenames of the periods are the same");
+        }
+    }
+
+    // Delete the file N rotations ago.
+    // Throw spdlog_ex on failure to delete the old file.
+    void delete_old_() {
+        using details::os::filename_to_str;
+        using details::os::remove_if_exists;
+
+        filename_t current_file = file_helper_.filename();
+        if (filenames_q_.full()) {
+            auto old_filename = std::move(filenames_q_.front());
+            filenames_q_.pop_front();
+            bool ok = remove_if_exists(old_filename) == 0;
+            if (!ok) {
+                filenames_q_.push_back(std::move(current_file));
+                throw_spdlog_ex("Failed removing hybrid rotating file " +
+                                    filename_to_str(old_filename),
+                                errno);
+            }
+        }
+        filenames_q_.push_back(std::move(current_file));
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::chrono::minutes rotation_interval_;
+    log_clock::time_point rotation_tp_;
+    tm period_tm_{};
+    std::size_t index_ = 0;
+    std::size_t current_size_ = 0;
+    details::file_helper file_helper_;
+    uint16_t max_files_;
+    details::circular_q<filename_t> filenames_q_;
+};
+
+using hybrid_rotating_file_sink_mt = hybrid_rotating_file_sink<std::mutex>;
+using hybrid_rotating_file_sink_st = hybrid_rotating_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_rotating_logger_mt(
+    const std::string &logger_name,
+    const filename_t &filename,
+    size_t max_file_size,
+    std::chrono::minutes rotation_interval = std::chrono::hours(24),
+    uint16_t max_files = 0,
+    const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::hybrid_rotating_file_sink_mt>(
+        logger_name, filename, max_file_size, rotation_interval, max_files, event_handlers);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> hybrid_rotating_logger_st(
+    const std::string &logger_name,
+    const filename_t &filename,
+    size_t max_file_size,
+    std::chrono::minutes rotation_interval = std::chrono::hours(24),
+    uint16_t max_files = 0,
+    const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::hybrid_rotating_file_sink_st>(
+        logger_name, filename, max_file_size, rotation_interval, max_files, event_handlers);
+}
+}  // namespace spdlog
@@ -0,0 +1,238 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+//
+// Rotating file sink based on size, where each rotated file gets the next index:
+// log.txt -> log.1.txt, then log.txt -> log.2.txt, ... and the oldest one is deleted,
+// so rotating takes one rename and one delete whatever max_files.
+// The last rotated file has the highest index. On construction, the dir is scanned for the files
+// of a previous run: the next index follows the last one, and the older files are deleted.
+// (not compatible with the files of rotating_file_sink, where log.1.txt is the last one)
+// Any file named <stem>.<digits><ext> in the dir is taken for a rotated file, e.g. log.2024.txt
+// next to log.txt: the next index follows 2024 and the rotated files below are deleted.
+// Don't keep other files with such names next to the log.
+//
+template <typename Mutex>
+class index_rotating_file_sink final : public base_sink<Mutex> {
+public:
+    index_rotating_file_sink(filename_t base_filename,
+                             std::size_t max_size,
+                             std::size_t max_files,
+                             bool rotate_on_open = false,
+                             const file_event_handlers &event_handlers = {},
+                             std::size_t write_buffer_size = 0)
+        : base_filename_(std::move(base_filename)),
+          max_size_(max_size),
+          max_files_(max_files),
+          file_helper_{event_handlers} {
+        if (max_size == 0) {
+            throw_spdlog_ex("index rotating sink constructor: max_size arg cannot be zero");
+        }
+        scan_files_();
+        file_helper_.set_write_buffer_size(write_buffer_size);
+        file_helper_.open(base_filename_);
+        current_size_ = file_helper_.size();  // expensive. called only once
+        if (rotate_on_open && current_size_ > 0) {
+            rotate_();
+            current_size_ = 0;
+        }
+    }
+
+    static filename_t calc_filename(const filename_t &filename, std::size_t index) {
+        return rotating_file_sink<Mutex>::calc_filename(filename, index);
+    }
+
+    filename_t filename() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_helper_.filename();
+    }
+
+    // the index of the next rotated file
+    std::size_t next_index() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return next_index_;
+    }
+
+    void rotate_now() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        rotate_();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &, string_view_t formatted) override {
+        auto new_size = current_size_ + formatted.size();
+
+        // rotate if the new estimated file size exceeds max size.
+        // rotate only if the real size > 0 to better deal with full disk (see issue #2261).
+        if (new_size > max_size_) {
+            file_helper_.flush();
+            if (file_helper_.size() > 0) {
+                rotate_();
+                new_size = formatted.size();
+            }
+        }
+        file_helper_.write(formatted);
+        current_size_ = new_size;
+    }
+
+    void flush_() override { file_helper_.flush(); }
+
+private:
+    // log.txt -> log.<next_index>.txt
+    // delete log.<next_index - max_files>.txt
+    void rotate_() {
+        using details::os::filename_to_str;
+
+        file_helper_.close();
+        if (max_files_ > 0 && details::os::path_exists(base_filename_)) {
+            filename_t target = calc_filename(base_filename_, next_index_);
+            if (details::os::rename(base_filename_, target) != 0) {
+                // if failed try again after a small delay (see rotating_file_sink).
+                details::os::sleep_for_millis(100);
+                if (details::os::rename(base_filename_, target) != 0) {
+                    // truncate the log file anyway to prevent it to grow beyond its limit!
+                    file_helper_.reopen(true);
+                    current_size_ = 0;
+                    throw_spdlog_ex("index_rotating_file_sink: failed renaming " +
+                                        filename_to_str(base_filename_) + " to " +
+                                        filename_to_str(target),
+                                    errno);
+                }
+            }
+            if (next_index_ > max_files_) {
+                (void)details::os::remove(calc_filename(base_filename_, next_index_ - max_files_));
+            }
+            next_index_++;
+        }
+        file_helper_.reopen(true);
+    }
+
+    // find the indexes of the rotated files in the dir, continue after the last one,
+    // and delete those that are not among the max_files last ones.
+    void scan_files_() {
+        auto sep = base_filename_.find_last_of(details::os::folder_seps_filename);
+        filename_t dir, name;
+        if (sep == filename_t::npos) {
+            name = base_filename_;
+        } else {
+            dir = base_filename_.substr(0, sep == 0 ? 1 : sep);
+            name = base_filename_.substr(sep + 1);
+        }
+        filename_t stem, ext;
+        std::tie(stem, ext) = details::file_helper::split_by_extension(name);
+
+        std::vector<std::size_t> indexes;
+        for (const auto &entry : details::os::dir_entries(dir)) {
+            std::size_t index = 0;
+            if (parse_index_(entry, stem, ext, index)) {
+                indexes.push_back(index);
+            }
+        }
+        if (indexes.empty()) {
+            return;
+        }
+        std::sort(indexes.begin(), indexes.end());
+        next_index_ = indexes.back() + 1;
+        for (auto index : indexes) {
+            if (index + max_files_ >= next_index_) {
+                break;
+            }
+            (void)details::os::remove(calc_filename(base_filename_, index));
+        }
+    }
+
+    // <stem>.<index><ext>, whoever wrote it (see the class comment)
+    static bool parse_index_(const filename_t &entry,
+                             const filename_t &stem,
+                             const filename_t &ext,
+                             std::size_t &index) {
+        auto first = stem.size() + 1;
+        if (entry.size() <= first + ext.size() || entry.compare(0, stem.size(), stem) != 0 ||
+            entry[stem.size()] != '.' ||
+            entry.compare(entry.size() - ext.size(), ext.size(), ext) != 0) {
+            return false;
+        }
+        auto last = entry.size() - ext.size();
+        if (last - first > 18) {
+            return false;
+        }
+        index = 0;
+        for (auto i = first; i < last; i++) {
+            if (entry[i] < '0' || entry[i] > '9') {
+                return false;
+            }
+            index = index * 10 + static_cast<std::size_t>(entry[i] - '0');
+        }
+        return index > 0;
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    std::size_t current_size_ = 0;
+    std::size_t next_index_ = 1;
+    details::file_helper file_helper_;
+};
+
+using index_rotating_file_sink_mt = index_rotating_file_sink<std::mutex>;
+using index_rotating_file_sink_st = index_rotating_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> index_rotating_logger_mt(
+    const std::string &logger_name,
+    const filename_t &filename,
+    size_t max_file_size,
+    size_t max_files,
+    bool rotate_on_open = false,
+    const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::index_rotating_file_sink_mt>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> index_rotating_logger_st(
+    const std::string &logger_name,
+    const filename_t &filename,
+    size_t max_file_size,
+    size_t max_files,
+    bool rotate_on_open = false,
+    const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::index_rotating_file_sink_st>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+}
+
+}  // namespace spdlog
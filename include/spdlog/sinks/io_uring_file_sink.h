@@ -0,0 +1,140 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/io_uring_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// File sink for linux that writes through io_uring (see details::io_uring_file).
+// The formatted lines are gathered in buffers of buffer_size bytes, and a full buffer is submitted
+// to the kernel instead of being written by the logging thread. At most max_in_flight buffers are
+// being written at once: when all of them are, logging waits for one to complete.
+// flush() submits the current buffer without waiting for it to be written, drain() waits.
+// With a sync_interval, an fdatasync is submitted when that much time has passed since the last
+// one (checked on the times of the logged messages).
+
+namespace spdlog {
+namespace sinks {
+
+struct io_uring_file_sink_config {
+    size_t buffer_size = 256 * 1024;
+    size_t max_in_flight = 8;
+    std::chrono::milliseconds sync_interval{0};  // 0: never sync
+    bool use_io_uring = true;                    // false: write with pwrite() instead
+};
+
+template <typename Mutex>
+class io_uring_file_sink final : public base_sink<Mutex> {
+public:
+    explicit io_uring_file_sink(const filename_t &filename,
+                                bool truncate = false,
+                                const io_uring_file_sink_config &config = {})
+        : config_{config},
+          file_{config.buffer_size, config.max_in_flight, config.use_io_uring} {
+        file_.open(filename, truncate);
+    }
+
+    const filename_t &filename() const { return file_.filename(); }
+
+    // false if io_uring is not available and the sink writes with pwrite()
+    bool uses_io_uring() const { return file_.uses_io_uring(); }
+
+    // submit the current buffer and wait until everything submitted is written
+    void drain() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        flush_();
+        file_.wait_all();
+    }
+
+    details::io_uring_file_stats stats() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_.stats();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++) {
+            base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+        }
+        file_.write(string_view_t(formatted.data(), formatted.size()));
+        sync_if_due_(msgs[count - 1]->time);
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override {
+        file_.write(formatted);
+        sync_if_due_(msg.time);
+    }
+
+    void sink_formatted_batch_(const details::log_msg *const *msgs,
+                               size_t count,
+                               const shared_format &shared) override {
+        file_.write(string_view_t(shared.formatted.data(), shared.formatted.size()));
+        sync_if_due_(msgs[count - 1]->time);
+    }
+
+    void flush_() override { file_.flush(); }
+
+private:
+    io_uring_file_sink_config config_;
+    details::io_uring_file file_;
+    log_clock::time_point last_sync_{};
+
+    void sync_if_due_(log_clock::time_point now) {
+        if (config_.sync_interval.count() == 0) {
+            return;
+        }
+        if (last_sync_ == log_clock::time_point{}) {
+            last_sync_ = now;
+        } else if (now - last_sync_ >= config_.sync_interval) {
+            last_sync_ = now;
+            file_.sync();
+        }
+    }
+};
+
+using io_uring_file_sink_mt = io_uring_file_sink<std::mutex>;
+using io_uring_file_sink_st = io_uring_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> io_uring_logger_mt(
+    const std::string &logger_name,
+    const filename_t &filename,
+    bool truncate = false,
+    const sinks::io_uring_file_sink_config &config = {}) {
+    return Factory::template create<sinks::io_uring_file_sink_mt>(logger_name, filename, truncate,
+                                                                  config);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> io_uring_logger_st(
+    const std::string &logger_name,
+    const filename_t &filename,
+    bool truncate = false,
+    const sinks::io_uring_file_sink_config &config = {}) {
+    return Factory::template create<sinks::io_uring_file_sink_st>(logger_name, filename, truncate,
+                                                                  config);
+}
+
+}  // namespace spdlog
@@ -0,0 +1,164 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/mmap_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <cerrno>
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+
+//
+// Rotating file sink based on size, writing through a memory mapping (see details::mmap_file).
+// Each file is preallocated to max_size and mapped, so logging a line is a memcpy, without
+// syscalls. On rotation the file is truncated to its written size, and the next one is mapped.
+// The files are named and rotated like with rotating_file_sink.
+//
+template <typename Mutex>
+class mmap_rotating_file_sink final : public base_sink<Mutex> {
+public:
+    mmap_rotating_file_sink(filename_t base_filename,
+                            std::size_t max_size,
+                            std::size_t max_files,
+                            bool rotate_on_open = false)
+        : base_filename_(std::move(base_filename)),
+          max_size_(max_size),
+          max_files_(max_files) {
+        if (max_size == 0) {
+            throw_spdlog_ex("mmap rotating sink constructor: max_size arg cannot be zero");
+        }
+        if (max_files > 200000) {
+            throw_spdlog_ex("mmap rotating sink constructor: max_files arg cannot exceed 200000");
+        }
+        file_.open(calc_filename(base_filename_, 0), max_size_);
+        if (rotate_on_open && file_.size() > 0) {
+            rotate_();
+        }
+    }
+
+    static filename_t calc_filename(const filename_t &filename, std::size_t index) {
+        return rotating_file_sink<Mutex>::calc_filename(filename, index);
+    }
+
+    filename_t filename() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        return file_.filename();
+    }
+
+    void rotate_now() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        rotate_();
+    }
+
+    // wait until the written lines are on disk
+    void sync() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        file_.sync();
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    // the written size is known exactly: no need to check the real size before rotating.
+    // a line bigger than max_size goes alone in its file, which grows to fit it.
+    void sink_formatted_(const details::log_msg &, string_view_t formatted) override {
+        if (file_.size() + formatted.size() > max_size_ && file_.size() > 0) {
+            rotate_();
+        }
+        file_.write(formatted);
+    }
+
+    // the lines are already in the page cache
+    void flush_() override { file_.flush(); }
+
+private:
+    // Rotate files:
+    // log.txt -> log.1.txt
+    // log.1.txt -> log.2.txt
+    // log.2.txt -> log.3.txt
+    // log.3.txt -> delete
+    void rotate_() {
+        using details::os::filename_to_str;
+        using details::os::path_exists;
+
+        file_.close();
+        for (auto i = max_files_; i > 0; --i) {
+            filename_t src = calc_filename(base_filename_, i - 1);
+            if (!path_exists(src)) {
+                continue;
+            }
+            filename_t target = calc_filename(base_filename_, i);
+            if (!rename_file_(src, target)) {
+                // if failed try again after a small delay.
+                details::os::sleep_for_millis(100);
+                if (!rename_file_(src, target)) {
+                    // truncate the log file anyway to prevent it to grow beyond its limit!
+                    file_.open(calc_filename(base_filename_, 0), max_size_, true);
+                    throw_spdlog_ex("mmap_rotating_file_sink: failed renaming " +
+                                        filename_to_str(src) + " to " + filename_to_str(target),
+                                    errno);
+                }
+            }
+        }
+        file_.open(calc_filename(base_filename_, 0), max_size_, true);
+    }
+
+    // delete the target if exists, and rename the src file  to target
+    // return true on success, false otherwise.
+    bool rename_file_(const filename_t &src_filename, const filename_t &target_filename) {
+        (void)details::os::remove(target_filename);
+        return details::os::rename(src_filename, target_filename) == 0;
+    }
+
+    filename_t base_filename_;
+    std::size_t max_size_;
+    std::size_t max_files_;
+    details::mmap_file file_;
+};
+
+using mmap_rotating_file_sink_mt = mmap_rotating_file_sink<std::mutex>;
+using mmap_rotating_file_sink_st = mmap_rotating_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_rotating_logger_mt(const std::string &logger_name,
+                                                       const filename_t &filename,
+                                                       size_t max_file_size,
+                                                       size_t max_files,
+                                                       bool rotate_on_open = false) {
+    return Factory::template create<sinks::mmap_rotating_file_sink_mt>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_rotating_logger_st(const std::string &logger_name,
+                                                       const filename_t &filename,
+                                                       size_t max_file_size,
+                                                       size_t max_files,
+                                                       bool rotate_on_open = false) {
+    return Factory::template create<sinks::mmap_rotating_file_sink_st>(
+        logger_name, filename, max_file_size, max_files, rotate_on_open);
+}
+
+}  // namespace spdlog
@@ -10,15 +10,18 @@
 #include <spdlog/common.h>
 
 #include <spdlog/details/file_helper.h>
+#include <spdlog/details/lz4_frame.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/fmt/fmt.h>
 
 #include <cerrno>
 #include <chrono>
 #include <ctime>
+#include <map>
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
 
 namespace spdlog {
 namespace sinks {
@@ -29,11 +32,13 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     std::size_t max_size,
     std::size_t max_files,
     bool rotate_on_open,
-    const file_event_handlers &event_handlers)
+    const file_event_handlers &event_handlers,
+    const file_sink_options &options)
     : base_filename_(std::move(base_filename)),
       max_size_(max_size),
       max_files_(max_files),
-      file_helper_{event_handlers} {
+      file_helper_{event_handlers},
+      compress_rotated_(options.compress_rotated) {
     if (max_size == 0) {
         throw_spdlog_ex("rotating sink constructor: max_size arg cannot be zero");
     }
@@ -41,7 +46,13 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     if (max_files > 200000) {
         throw_spdlog_ex("rotating sink constructor: max_files arg cannot exceed 200000");
     }
+    if (options.background_rotation || options.compress_rotated) {
+        rotation_worker_ = details::make_unique<details::background_worker>();
+    }
+    file_helper_.set_write_buffer_size(options.write_buffer_size);
+    file_helper_.set_compression(options.compress);
     file_helper_.open(calc_filename(base_filename_, 0));
+    finish_pending_rotations_();
     current_size_ = file_helper_.size();  // expensive. called only once
     if (rotate_on_open && current_size_ > 0) {
         rotate_();
@@ -75,11 +86,31 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_now() {
     rotate_();
 }
 
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::wait_rotation() {
+    if (rotation_worker_) {
+        rotation_worker_->wait();
+    }
+}
+
 template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
-    auto new_size = current_size_ + formatted.size();
+    sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+}
+
+template <typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::accepts_formatted_() const {
+    return true;
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                              string_view_t formatted) {
+    // the size of a compressed file is known without a syscall, and shrinks as blocks are written
+    auto new_size =
+        (file_helper_.compressed() ? file_helper_.size() : current_size_) + formatted.size();
 
     // rotate if the new estimated file size exceeds max size.
     // rotate only if the real size > 0 to better deal with full disk (see issue #2261).
@@ -108,15 +139,174 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_() {
 template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
     using details::os::filename_to_str;
-    using details::os::path_exists;
+
+    if (rotation_worker_ && max_files_ > 0) {
+        rotate_in_background_();
+        return;
+    }
+    file_helper_.close();
+    filename_t failed_src, failed_target;
+    if (!shift_files_(base_filename_, max_files_, calc_filename(base_filename_, 0), filename_t{},
+                      failed_src, failed_target)) {
+        file_helper_.reopen(
+            true);  // truncate the log file anyway to prevent it to grow beyond its limit!
+        current_size_ = 0;
+        throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(failed_src) +
+                            " to " + filename_to_str(failed_target),
+                        errno);
+    }
+    file_helper_.reopen(true);
+}
+
+// log.txt -> log.rotating<count>.txt, then in the background:
+// log.2.txt -> log.3.txt
+// log.1.txt -> log.2.txt
+// log.rotating<count>.txt -> log.1.txt
+// the jobs run in order, so the renames of successive rotations don't interleave.
+// with compress_rotated, log.rotating<count>.txt is first compressed to
+// log.rotating<count>.txt.lz4, and the rotated files are named log.N.txt.lz4.
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_in_background_() {
+    using details::os::filename_to_str;
 
     file_helper_.close();
-    for (auto i = max_files_; i > 0; --i) {
-        filename_t src = calc_filename(base_filename_, i - 1);
+    filename_t current = calc_filename(base_filename_, 0);
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    filename_t rotated = fmt_lib::format(SPDLOG_FMT_STRING(SPDLOG_FILENAME_T("{}.rotating{}{}")),
+                                         basename, ++rotation_count_, ext);
+    if (details::os::path_exists(current) && !rename_file_(current, rotated)) {
+        file_helper_.reopen(true);  // truncate the log file anyway, like rotate_()
+        current_size_ = 0;
+        throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(current) +
+                            " to " + filename_to_str(rotated),
+                        errno);
+    }
+    file_helper_.reopen(true);
+
+    auto base_filename = base_filename_;
+    auto max_files = max_files_;
+    // the files written compressed are already compressed
+    bool compress = compress_rotated_ && !file_helper_.compressed();
+    rotation_worker_->post([base_filename, max_files, rotated, compress] {
+        filename_t first = rotated;
+        filename_t suffix;
+        if (compress) {
+            suffix = SPDLOG_FILENAME_T(".lz4");
+            first += suffix;
+            details::lz4_compress_file(rotated, first);
+        }
+        filename_t failed_src, failed_target;
+        if (!shift_files_(base_filename, max_files, first, suffix, failed_src, failed_target)) {
+            int err = errno;
+            (void)details::os::remove(first);  // don't leave it behind
+            throw_spdlog_ex("rotating_file_sink: failed renaming " +
+                                filename_to_str(failed_src) + " to " +
+                                filename_to_str(failed_target),
+                            err);
+        }
+    });
+    rotation_worker_->rethrow_error();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::finish_pending_rotations_() {
+    using details::os::filename_to_str;
+
+    filename_t basename, ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    auto sep = basename.find_last_of(details::os::folder_seps_filename);
+    filename_t dir =
+        sep == filename_t::npos ? filename_t{} : basename.substr(0, sep == 0 ? 1 : sep);
+    filename_t prefix = sep == filename_t::npos ? basename : basename.substr(sep + 1);
+    prefix += SPDLOG_FILENAME_T(".rotating");
+    const filename_t lz4_ext = SPDLOG_FILENAME_T(".lz4");
+
+    // log.rotating<N>.txt, and log.rotating<N>.txt.lz4 if compressed, by N
+    std::map<std::size_t, std::pair<bool, bool>> pending;  // N -> (plain, compressed)
+    for (auto &entry : details::os::dir_entries(dir)) {
+        if (entry.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        size_t pos = prefix.size(), n = 0;
+        for (; pos < entry.size() && entry[pos] >= '0' && entry[pos] <= '9'; pos++) {
+            n = n * 10 + static_cast<size_t>(entry[pos] - '0');
+        }
+        if (pos == prefix.size()) {
+            continue;
+        }
+        auto rest = entry.substr(pos);
+        if (rest == ext) {
+            pending[n].first = true;
+        } else if (rest == ext + lz4_ext) {
+            pending[n].second = true;
+        }
+    }
+    if (pending.empty()) {
+        return;
+    }
+    // the rotations of this run don't reuse their names, which may still be pending
+    rotation_count_ = pending.rbegin()->first;
+
+    auto base_filename = base_filename_;
+    auto max_files = max_files_;
+    bool compress = compress_rotated_ && !file_helper_.compressed();
+    auto finish = [base_filename, max_files, compress, basename, ext, lz4_ext, pending] {
+        for (auto &p : pending) {
+            filename_t rotated = fmt_lib::format(
+                SPDLOG_FMT_STRING(SPDLOG_FILENAME_T("{}.rotating{}{}")), basename, p.first, ext);
+            filename_t first = rotated;
+            filename_t suffix;
+            if (p.second.first) {
+                // the plain file is complete: its compression didn't finish
+                if (p.second.second) {
+                    (void)details::os::remove(rotated + lz4_ext);
+                }
+                if (compress && max_files > 0) {
+                    suffix = lz4_ext;
+                    first += suffix;
+                    details::lz4_compress_file(rotated, first);
+                }
+            } else {
+                suffix = lz4_ext;
+                first += suffix;
+            }
+            if (max_files == 0) {
+                (void)details::os::remove(first);
+                continue;
+            }
+            filename_t failed_src, failed_target;
+            if (!shift_files_(base_filename, max_files, first, suffix, failed_src,
+                              failed_target)) {
+                throw_spdlog_ex("rotating_file_sink: failed renaming " +
+                                    filename_to_str(failed_src) + " to " +
+                                    filename_to_str(failed_target),
+                                errno);
+            }
+        }
+    };
+    if (rotation_worker_) {
+        rotation_worker_->post(finish);
+    } else {
+        finish();
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::shift_files_(const filename_t &base_filename,
+                                                           std::size_t max_files,
+                                                           const filename_t &first,
+                                                           const filename_t &suffix,
+                                                           filename_t &failed_src,
+                                                           filename_t &failed_target) {
+    using details::os::path_exists;
+
+    for (auto i = max_files; i > 0; --i) {
+        filename_t src = i == 1 ? first : calc_filename(base_filename, i - 1) + suffix;
         if (!path_exists(src)) {
             continue;
         }
-        filename_t target = calc_filename(base_filename_, i);
+        filename_t target = calc_filename(base_filename, i) + suffix;
 
         if (!rename_file_(src, target)) {
             // if failed try again after a small delay.
@@ -124,16 +314,13 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
             // rates can cause the rename to fail with permission denied (because of antivirus?).
             details::os::sleep_for_millis(100);
             if (!rename_file_(src, target)) {
-                file_helper_.reopen(
-                    true);  // truncate the log file anyway to prevent it to grow beyond its limit!
-                current_size_ = 0;
-                throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(src) +
-                                    " to " + filename_to_str(target),
-                                errno);
+                failed_src = std::move(src);
+                failed_target = std::move(target);
+                return false;
             }
         }
     }
-    file_helper_.reopen(true);
+    return true;
 }
 
 // delete the target if exists, and rename the src file  to target
@@ -3,12 +3,14 @@
 
 #pragma once
 
+#include <spdlog/details/background_worker.h>
 #include <spdlog/details/file_helper.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/sinks/base_sink.h>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -16,7 +18,15 @@ namespace spdlog {
 namespace sinks {
 
 //
-// Rotating file sink based on size
+// Rotating file sink based on size.
+// See file_sink_options for the write buffer and the compression.
+// With options.background_rotation, rotating only renames the current file to a temporary name and
+// opens a new one: the renames of the older files run on a background thread. A failure of these
+// renames is thrown at the next rotation.
+// With options.compress_rotated, the rotated files are compressed on the background thread too
+// (log.1.txt.lz4), which implies background_rotation.
+// With options.compress, max_size bounds the compressed size of the file: the lines count at their
+// uncompressed size until their block is compressed, then at its size.
 //
 template <typename Mutex>
 class rotating_file_sink final : public base_sink<Mutex> {
@@ -25,13 +35,18 @@ public:
                        std::size_t max_size,
                        std::size_t max_files,
                        bool rotate_on_open = false,
-                       const file_event_handlers &event_handlers = {});
+                       const file_event_handlers &event_handlers = {},
+                       const file_sink_options &options = {});
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
     void rotate_now();
+    // wait until the background renames are done
+    void wait_rotation();
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    bool accepts_formatted_() const override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
     void flush_() override;
 
 private:
@@ -42,15 +57,37 @@ private:
     // log.3.txt -> delete
     void rotate_();
 
+    // rename the current file to a temporary name, open a new one,
+    // and rename the files in the background
+    void rotate_in_background_();
+
+    // the temporary files of the background rotations that a previous run didn't finish (e.g. it
+    // was killed) are shifted into the numbered files, oldest first, or removed if max_files is 0.
+    // they would be overwritten by the next rotations otherwise.
+    void finish_pending_rotations_();
+
+    // rename log.N-1.txt -> log.N.txt ... log.1.txt -> log.2.txt, then first -> log.1.txt,
+    // with suffix appended to the names of the rotated files.
+    // return false if a rename failed, with its names in failed_src and failed_target.
+    static bool shift_files_(const filename_t &base_filename,
+                             std::size_t max_files,
+                             const filename_t &first,
+                             const filename_t &suffix,
+                             filename_t &failed_src,
+                             filename_t &failed_target);
+
     // delete the target if exists, and rename the src file  to target
     // return true on success, false otherwise.
-    bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
+    static bool rename_file_(const filename_t &src_filename, const filename_t &target_filename);
 
     filename_t base_filename_;
     std::size_t max_size_;
     std::size_t max_files_;
     std::size_t current_size_;
     details::file_helper file_helper_;
+    std::unique_ptr<details::background_worker> rotation_worker_;
+    std::size_t rotation_count_ = 0;
+    bool compress_rotated_;
 };
 
 using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
@@ -68,9 +105,10 @@ inline std::shared_ptr<logger> rotating_logger_mt(const std::string &logger_name
                                                   size_t max_file_size,
                                                   size_t max_files,
                                                   bool rotate_on_open = false,
-                                                  const file_event_handlers &event_handlers = {}) {
+                                                  const file_event_handlers &event_handlers = {},
+                                                  const file_sink_options &options = {}) {
     return Factory::template create<sinks::rotating_file_sink_mt>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -79,9 +117,10 @@ inline std::shared_ptr<logger> rotating_logger_st(const std::string &logger_name
                                                   size_t max_file_size,
                                                   size_t max_files,
                                                   bool rotate_on_open = false,
-                                                  const file_event_handlers &event_handlers = {}) {
+                                                  const file_event_handlers &event_handlers = {},
+                                                  const file_sink_options &options = {}) {
     return Factory::template create<sinks::rotating_file_sink_st>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers, options);
 }
 }  // namespace spdlog
 
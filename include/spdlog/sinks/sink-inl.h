@@ -20,3 +20,62 @@ SPDLOG_INLINE void spdlog::sinks::sink::set_level(level::level_enum log_level) {
 SPDLOG_INLINE spdlog::level::level_enum spdlog::sinks::sink::level() const {
     return static_cast<spdlog::level::level_enum>(level_.load(std::memory_order_relaxed));
 }
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(const details::log_msg *const *msgs,
+                                                  size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        log(*msgs[i]);
+    }
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_shared(const details::log_msg &msg, shared_format &) {
+    log(msg);
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch_shared(const details::log_msg *const *msgs,
+                                                         size_t count,
+                                                         shared_format &) {
+    log_batch(msgs, count);
+}
+
+SPDLOG_INLINE spdlog::string_view_t spdlog::sinks::shared_format::line(size_t i) const {
+    if (ends.empty()) {
+        return string_view_t(formatted.data(), formatted.size());
+    }
+    size_t begin = i == 0 ? 0 : ends[i - 1];
+    return string_view_t(formatted.data() + begin, ends[i] - begin);
+}
+
+SPDLOG_INLINE void spdlog::sinks::format_sharing::reset() { key_valid_ = false; }
+
+SPDLOG_INLINE bool spdlog::sinks::format_sharing::format(formatter &f,
+                                                         const details::log_msg *const *msgs,
+                                                         size_t count,
+                                                         shared_format &shared) {
+    if (!key_valid_) {
+        auto key = f.format_key();
+        key_ = key.empty() ? nullptr : std::make_shared<const std::string>(std::move(key));
+        key_valid_ = true;
+    }
+    if (key_ == nullptr) {
+        return false;
+    }
+    if (shared.key != nullptr) {
+        return shared.key == key_ || *shared.key == *key_;
+    }
+    // start over if a previous sink failed while formatting
+    shared.formatted.clear();
+    shared.ends.clear();
+    for (size_t i = 0; i < count; i++) {
+        msgs[i]->color_range_start = 0;
+        msgs[i]->color_range_end = 0;
+        f.format(*msgs[i], shared.formatted);
+        if (count > 1) {
+            shared.ends.push_back(shared.formatted.size());
+        }
+    }
+    shared.color_range_start = msgs[0]->color_range_start;
+    shared.color_range_end = msgs[0]->color_range_end;
+    shared.key = key_;
+    return true;
+}
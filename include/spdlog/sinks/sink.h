@@ -6,13 +6,64 @@
 #include <spdlog/details/log_msg.h>
 #include <spdlog/formatter.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace spdlog {
 
 namespace sinks {
+
+// messages formatted once for all the sinks of a logger whose formatters have the same
+// format key (see formatter::format_key()), e.g. sinks with the same pattern.
+struct SPDLOG_API shared_format {
+    // the formatted messages, one after the other
+    memory_buf_t formatted;
+    // end of each message in formatted, when there are more than one
+    std::vector<size_t> ends;
+    // format key of the formatter that formatted them. null while not formatted.
+    std::shared_ptr<const std::string> key;
+    // color range of a single message (see log_msg::color_range_start)
+    size_t color_range_start = 0;
+    size_t color_range_end = 0;
+
+    // the i-th formatted message
+    string_view_t line(size_t i) const;
+};
+
+// used by the sinks to format the messages in a shared_format, or to find out that they were
+// formatted by an equivalent formatter
+class SPDLOG_API format_sharing {
+public:
+    // call when the sink's formatter changes
+    void reset();
+
+    // format the messages with f in shared if not done yet.
+    // return true if shared holds the messages as f formats them.
+    bool format(formatter &f,
+                const details::log_msg *const *msgs,
+                size_t count,
+                shared_format &shared);
+
+private:
+    std::shared_ptr<const std::string> key_;
+    bool key_valid_ = false;
+};
+
 class SPDLOG_API sink {
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+    // log count messages at once (e.g. a batch taken from the async queue).
+    // the default implementation calls log() for each message.
+    virtual void log_batch(const details::log_msg *const *msgs, size_t count);
+    // same as log() and log_batch(), but the messages may be formatted in shared by a previous
+    // sink with an equivalent formatter, or be formatted there for the next ones.
+    // the default implementations ignore shared.
+    virtual void log_shared(const details::log_msg &msg, shared_format &shared);
+    virtual void log_batch_shared(const details::log_msg *const *msgs,
+                                  size_t count,
+                                  shared_format &shared);
     virtual void flush() = 0;
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
@@ -54,9 +54,35 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     if (handle_ == INVALID_HANDLE_VALUE) {
         return;
     }
+#endif  // _WIN32
     std::lock_guard<mutex_t> lock(mutex_);
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
+    write_(string_view_t(formatted.data(), formatted.size()));
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log_shared(const details::log_msg &msg,
+                                                              shared_format &shared) {
+#ifdef _WIN32
+    if (handle_ == INVALID_HANDLE_VALUE) {
+        return;
+    }
+#endif  // _WIN32
+    std::lock_guard<mutex_t> lock(mutex_);
+    const details::log_msg *msgs[] = {&msg};
+    if (format_sharing_.format(*formatter_, msgs, 1, shared)) {
+        write_(shared.line(0));
+    } else {
+        memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+        write_(string_view_t(formatted.data(), formatted.size()));
+    }
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::write_(string_view_t formatted) {
+#ifdef _WIN32
     auto size = static_cast<DWORD>(formatted.size());
     DWORD bytes_written = 0;
     bool ok = ::WriteFile(handle_, formatted.data(), size, &bytes_written, nullptr) != 0;
@@ -65,9 +91,6 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
                         std::to_string(::GetLastError()));
     }
 #else
-    std::lock_guard<mutex_t> lock(mutex_);
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
     details::os::fwrite_bytes(formatted.data(), formatted.size(), file_);
 #endif                // _WIN32
     ::fflush(file_);  // flush every line to terminal
@@ -83,6 +106,7 @@ template <typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_pattern(const std::string &pattern) {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    format_sharing_.reset();
 }
 
 template <typename ConsoleMutex>
@@ -90,6 +114,7 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_formatter(
     std::unique_ptr<spdlog::formatter> sink_formatter) {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::move(sink_formatter);
+    format_sharing_.reset();
 }
 
 // stdout sink
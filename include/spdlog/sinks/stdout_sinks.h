@@ -30,6 +30,7 @@ public:
     stdout_sink_base &operator=(stdout_sink_base &&other) = delete;
 
     void log(const details::log_msg &msg) override;
+    void log_shared(const details::log_msg &msg, shared_format &shared) override;
     void flush() override;
     void set_pattern(const std::string &pattern) override;
 
@@ -42,6 +43,10 @@ protected:
 #ifdef _WIN32
     HANDLE handle_;
 #endif  // WIN32
+    format_sharing format_sharing_;
+
+    // write a formatted message, under the lock
+    void write_(string_view_t formatted);
 };
 
 template <typename ConsoleMutex>
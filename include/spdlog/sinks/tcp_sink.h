@@ -57,12 +57,26 @@ protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    void sink_formatted_(const spdlog::details::log_msg &, string_view_t formatted) override {
         if (!client_.is_connected()) {
             client_.connect(config_.server_host, config_.server_port);
         }
         client_.send(formatted.data(), formatted.size());
     }
 
+    // a stream: send the messages of the batch at once
+    void sink_formatted_batch_(const spdlog::details::log_msg *const *msgs,
+                               size_t count,
+                               const shared_format &shared) override {
+        sink_formatted_(*msgs[count - 1],
+                        string_view_t(shared.formatted.data(), shared.formatted.size()));
+    }
+
     void flush_() override {}
     tcp_sink_config config_;
     details::tcp_client client_;
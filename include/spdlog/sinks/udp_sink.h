@@ -45,6 +45,13 @@ protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    bool accepts_formatted_() const override { return true; }
+
+    // one datagram per message
+    void sink_formatted_(const spdlog::details::log_msg &, string_view_t formatted) override {
         client_.send(formatted.data(), formatted.size());
     }
 
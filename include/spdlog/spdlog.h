@@ -283,12 +283,24 @@ inline void critical(const T &msg) {
 // SPDLOG_LEVEL_OFF
 //
 
+// with SPDLOG_COMPILED_FORMAT, the format string (a string literal) is parsed at compile time.
+// needs __VA_OPT__ (C++20) to tell the format string from the arguments.
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT) && \
+    defined(__cplusplus) && __cplusplus >= 202002L
+    #define SPDLOG_EXPAND_(x) x
+    #define SPDLOG_COMPILE_FORMAT_(fmt, ...) FMT_COMPILE(fmt) __VA_OPT__(, ) __VA_ARGS__
+    #define SPDLOG_LOGGER_CALL_ARGS_(...) SPDLOG_EXPAND_(SPDLOG_COMPILE_FORMAT_(__VA_ARGS__))
+#else
+    #define SPDLOG_LOGGER_CALL_ARGS_(...) __VA_ARGS__
+#endif
+
 #ifndef SPDLOG_NO_SOURCE_LOC
-    #define SPDLOG_LOGGER_CALL(logger, level, ...) \
-        (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, __VA_ARGS__)
+    #define SPDLOG_LOGGER_CALL(logger, level, ...)                                     \
+        (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, \
+                      SPDLOG_LOGGER_CALL_ARGS_(__VA_ARGS__))
 #else
     #define SPDLOG_LOGGER_CALL(logger, level, ...) \
-        (logger)->log(spdlog::source_loc{}, level, __VA_ARGS__)
+        (logger)->log(spdlog::source_loc{}, level, SPDLOG_LOGGER_CALL_ARGS_(__VA_ARGS__))
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
@@ -0,0 +1,704 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Pattern formatter specialized at compile time for a pattern known at build time (C++17).
+// The pattern is parsed by constexpr code, and format() renders each of its flags inline: no
+// virtual call per flag, no vector of flag formatters, and the local time is computed only if the
+// pattern has time flags. The output is the same as pattern_formatter's with the same pattern,
+// except for custom flags, which aren't supported.
+//
+// C++20:
+//    sink->set_formatter(std::make_unique<spdlog::static_pattern_formatter<"[%H:%M:%S] %v">>());
+// C++17:
+//    sink->set_formatter(
+//        spdlog::make_static_pattern_formatter(SPDLOG_STATIC_PATTERN("[%H:%M:%S] %v")));
+
+#include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/timestamp_cache.h>
+#include <spdlog/formatter.h>
+#include <spdlog/pattern_formatter.h>
+
+#ifndef SPDLOG_NO_TLS
+    #include <spdlog/mdc.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+
+namespace spdlog {
+namespace details {
+namespace static_pattern {
+
+// flag, or literal chars of the pattern
+struct token {
+    char flag = '\0';  // '\0' for the literal chars [begin, begin + size) of the pattern
+    size_t begin = 0;
+    size_t size = 0;
+    padding_info padding{};
+    // runs of literals and flags of the second (see is_second_flag) are rendered once per second:
+    // the first token of a run has the index of its cache and the end of the run
+    size_t run_end = 0;
+    size_t run_index = 0;
+    bool in_run = false;  // in a run, after its first token
+};
+
+constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+constexpr bool is_flag(char flag) {
+    #ifndef SPDLOG_NO_TLS
+    constexpr const char *flags = "+vtnlLaAbhBcCYDxmdHIMSefFEprRTXzP^$@sg#!oiuO&";
+    #else
+    constexpr const char *flags = "+vtnlLaAbhBcCYDxmdHIMSefFEprRTXzP^$@sg#!oiuO";
+    #endif
+    for (auto *p = flags; *p != '\0'; ++p) {
+        if (*p == flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the flags rendered from the local (or utc) time
+constexpr bool is_time_flag(char flag) {
+    constexpr const char *flags = "+aAbhBcCYDxmdHIMSprRTXz";
+    for (auto *p = flags; *p != '\0'; ++p) {
+        if (*p == flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the flags rendered the same for every message of a second
+constexpr bool is_second_flag(char flag) {
+    constexpr const char *flags = "aAbhBcCYDxmdHIMSprRTXE";
+    for (auto *p = flags; *p != '\0'; ++p) {
+        if (*p == flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr bool is_elapsed_flag(char flag) {
+    return flag == 'o' || flag == 'i' || flag == 'u' || flag == 'O';
+}
+
+// the pad spec from pattern[i] (see pattern_formatter::handle_padspec_), i is advanced past it
+constexpr padding_info parse_padspec(const char *pattern, size_t &i) {
+    const size_t max_width = 64;
+    if (pattern[i] == '\0') {
+        return padding_info{};
+    }
+    auto side = padding_info::pad_side::left;
+    if (pattern[i] == '-') {
+        side = padding_info::pad_side::right;
+        ++i;
+    } else if (pattern[i] == '=') {
+        side = padding_info::pad_side::center;
+        ++i;
+    }
+    if (!is_digit(pattern[i])) {
+        return padding_info{};
+    }
+    size_t width = 0;
+    for (; is_digit(pattern[i]); ++i) {
+        width = width * 10 + static_cast<size_t>(pattern[i] - '0');
+    }
+    bool truncate = pattern[i] == '!';
+    if (truncate) {
+        ++i;
+    }
+    return padding_info{width < max_width ? width : max_width, side, truncate};
+}
+
+// parse the pattern like pattern_formatter::compile_pattern_(), to tokens if not null.
+// return the number of tokens.
+constexpr size_t parse(const char *pattern, token *tokens) {
+    size_t count = 0;
+    auto add = [&](token t) {
+        // merge the adjacent literal chars (e.g. "a%%b")
+        if (t.flag == '\0' && count > 0 && tokens != nullptr) {
+            auto &last = tokens[count - 1];
+            if (last.flag == '\0' && last.begin + last.size == t.begin) {
+                last.size += t.size;
+                return;
+            }
+        }
+        if (tokens != nullptr) {
+            tokens[count] = t;
+        }
+        count++;
+    };
+    size_t i = 0;
+    while (pattern[i] != '\0') {
+        if (pattern[i] != '%') {
+            add(token{'\0', i, 1, padding_info{}});
+            ++i;
+            continue;
+        }
+        ++i;
+        auto padding = parse_padspec(pattern, i);
+        if (pattern[i] == '\0') {
+            break;
+        }
+        auto flag = pattern[i];
+        auto pos = i++;
+        if (flag == '%') {
+            add(token{'\0', pos, 1, padding_info{}});
+        } else if (is_flag(flag)) {
+            add(token{flag, 0, 0, padding});
+        } else if (!padding.truncate_) {
+            // rendered as is, with its '%'
+            add(token{flag, 0, 0, padding_info{}});
+        } else {
+            // "%3!!": the '!' was the flag (see issue #1617)
+            padding.truncate_ = false;
+            add(token{'!', 0, 0, padding});
+            add(token{'\0', pos, 1, padding_info{}});
+        }
+    }
+    return count;
+}
+
+// the number of tokens before merging the literals
+constexpr size_t max_tokens(const char *pattern) { return parse(pattern, nullptr); }
+
+// mark the runs of at least two literals and flags of the second, with one of these flags
+constexpr size_t mark_runs(token *tokens, size_t count) {
+    size_t runs = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t end = i, flags = 0;
+        for (; end < count && (tokens[end].flag == '\0' || is_second_flag(tokens[end].flag));
+             end++) {
+            flags += tokens[end].flag != '\0' ? 1 : 0;
+        }
+        if (flags == 0 || end - i < 2) {
+            continue;
+        }
+        tokens[i].run_end = end;
+        tokens[i].run_index = runs++;
+        for (size_t j = i + 1; j < end; j++) {
+            tokens[j].in_run = true;
+        }
+        i = end - 1;
+    }
+    return runs;
+}
+
+struct parsed_pattern_counts {
+    size_t tokens;
+    size_t runs;
+};
+
+template <size_t N>
+constexpr std::pair<std::array<token, N>, parsed_pattern_counts> parse_tokens(
+    const char *pattern) {
+    std::array<token, N> tokens{};
+    size_t count = parse(pattern, tokens.data());
+    size_t runs = mark_runs(tokens.data(), count);
+    return {tokens, parsed_pattern_counts{count, runs}};
+}
+
+template <size_t N>
+constexpr bool any_flag(const std::pair<std::array<token, N>, parsed_pattern_counts> &parsed,
+                        bool (*pred)(char)) {
+    for (size_t i = 0; i < parsed.second.tokens; i++) {
+        if (parsed.first[i].flag != '\0' && pred(parsed.first[i].flag)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr const char *days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+constexpr const char *full_days[] = {"Sunday",   "Monday", "Tuesday", "Wednesday",
+                                     "Thursday", "Friday", "Saturday"};
+constexpr const char *months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+constexpr const char *full_months[] = {"January", "February", "March",     "April",
+                                       "May",     "June",     "July",      "August",
+                                       "September", "October", "November", "December"};
+
+inline const char *short_filename(const char *filename) {
+    if constexpr (sizeof(os::folder_seps) == 2) {
+        const char *rv = std::strrchr(filename, os::folder_seps[0]);
+        return rv != nullptr ? rv + 1 : filename;
+    } else {
+        const std::reverse_iterator<const char *> begin(filename + std::strlen(filename));
+        const std::reverse_iterator<const char *> end(filename);
+        const auto it = std::find_first_of(begin, end, std::begin(os::folder_seps),
+                                           std::end(os::folder_seps) - 1);
+        return it != end ? it.base() : filename;
+    }
+}
+
+    #ifndef SPDLOG_NO_TLS
+template <typename Padder>
+void format_mdc(const mdc::mdc_map_t &mdc_map, const padding_info &padding, memory_buf_t &dest) {
+    auto last_element = --mdc_map.end();
+    for (auto it = mdc_map.begin(); it != mdc_map.end(); ++it) {
+        const auto &key = it->first;
+        const auto &value = it->second;
+        size_t content_size = key.size() + value.size() + 1;  // 1 for ':'
+        if (it != last_element) {
+            content_size++;  // 1 for ' '
+        }
+        Padder p(content_size, padding, dest);
+        fmt_helper::append_string_view(key, dest);
+        dest.push_back(':');
+        fmt_helper::append_string_view(value, dest);
+        if (it != last_element) {
+            dest.push_back(' ');
+        }
+    }
+}
+    #endif
+
+// a pattern given as a template argument (C++20)
+    #if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template <size_t N>
+struct fixed_string {
+    constexpr fixed_string(const char (&str)[N]) {  // NOLINT: implicit, for the template argument
+        for (size_t i = 0; i < N; i++) {
+            data[i] = str[i];
+        }
+    }
+    char data[N]{};
+};
+
+template <fixed_string Pattern>
+struct fixed_pattern {
+    static constexpr const char *value() { return Pattern.data; }
+};
+    #endif
+
+}  // namespace static_pattern
+}  // namespace details
+
+// Pattern is a type whose static constexpr value() returns the pattern
+// (see SPDLOG_STATIC_PATTERN and static_pattern_formatter)
+template <typename Pattern>
+class basic_static_pattern_formatter final : public formatter {
+public:
+    explicit basic_static_pattern_formatter(
+        pattern_time_type time_type = pattern_time_type::local,
+        std::string eol = spdlog::details::os::default_eol)
+        : time_type_(time_type),
+          eol_(std::move(eol)) {}
+
+    std::unique_ptr<formatter> clone() const override {
+        return details::make_unique<basic_static_pattern_formatter>(time_type_, eol_);
+    }
+
+    void format(const details::log_msg &msg, memory_buf_t &dest) override {
+        if constexpr (needs_tm_ || run_count_ > 0) {
+            auto secs =
+                std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+            if (needs_tm_ && (secs != last_log_secs_ || !timestamp_)) {
+                timestamp_ = details::timestamp_cache::instance().get(msg.time, time_type_);
+                cached_tm_ = timestamp_->tm;
+            }
+            last_log_secs_ = secs;
+        }
+        format_tokens_(msg, dest, std::make_index_sequence<token_count_>{});
+        if constexpr (has_elapsed_) {
+            last_message_time_ = msg.time;
+        }
+        details::fmt_helper::append_string_view(eol_, dest);
+    }
+
+    // the key of pattern_formatter with the same pattern: it formats the same way
+    std::string format_key() const override {
+        std::string pattern = Pattern::value();
+        return std::to_string(pattern.size()) + ':' + pattern + ':' +
+               std::to_string(static_cast<int>(time_type_)) + ':' + (needs_tm_ ? '1' : '0') +
+               ':' + eol_;
+    }
+
+private:
+    using token = details::static_pattern::token;
+
+    static constexpr size_t max_tokens_ = details::static_pattern::max_tokens(Pattern::value());
+    static constexpr auto parsed_ =
+        details::static_pattern::parse_tokens<max_tokens_>(Pattern::value());
+    static constexpr size_t token_count_ = parsed_.second.tokens;
+    static constexpr size_t run_count_ = parsed_.second.runs;
+
+    static constexpr bool needs_tm_ =
+        details::static_pattern::any_flag(parsed_, details::static_pattern::is_time_flag);
+    static constexpr bool has_elapsed_ =
+        details::static_pattern::any_flag(parsed_, details::static_pattern::is_elapsed_flag);
+
+    pattern_time_type time_type_;
+    std::string eol_;
+    std::tm cached_tm_{};
+    std::shared_ptr<const details::timestamp> timestamp_;  // of cached_tm_, shared process-wide
+    std::chrono::seconds last_log_secs_{0};
+    log_clock::time_point last_message_time_{log_clock::now()};  // for the elapsed flags
+
+    struct run_cache {
+        memory_buf_t formatted;
+        std::chrono::seconds secs = (std::chrono::seconds::min)();
+    };
+    std::array<run_cache, run_count_> run_caches_;
+
+    template <size_t... I>
+    void format_tokens_(const details::log_msg &msg,
+                        memory_buf_t &dest,
+                        std::index_sequence<I...>) {
+        (format_token_<I>(msg, dest), ...);
+    }
+
+    template <size_t I>
+    void format_token_(const details::log_msg &msg, memory_buf_t &dest) {
+        constexpr token t = parsed_.first[I];
+        if constexpr (t.in_run) {
+            // rendered with the first token of the run
+        } else if constexpr (t.run_end > 0) {
+            auto &cache = run_caches_[t.run_index];
+            if (cache.secs != last_log_secs_) {
+                cache.formatted.clear();
+                format_run_<I>(msg, cache.formatted, std::make_index_sequence<t.run_end - I>{});
+                cache.secs = last_log_secs_;
+            }
+            details::fmt_helper::append_string_view(
+                string_view_t(cache.formatted.data(), cache.formatted.size()), dest);
+        } else {
+            format_item_<I>(msg, dest);
+        }
+    }
+
+    template <size_t First, size_t... I>
+    void format_run_(const details::log_msg &msg, memory_buf_t &dest, std::index_sequence<I...>) {
+        (format_item_<First + I>(msg, dest), ...);
+    }
+
+    template <size_t I>
+    void format_item_(const details::log_msg &msg, memory_buf_t &dest) {
+        constexpr token t = parsed_.first[I];
+        if constexpr (t.flag == '\0') {
+            if constexpr (t.size == 1) {
+                dest.push_back(Pattern::value()[t.begin]);
+            } else {
+                details::fmt_helper::append_string_view(
+                    string_view_t(Pattern::value() + t.begin, t.size), dest);
+            }
+        } else if constexpr (!details::static_pattern::is_flag(t.flag)) {
+            dest.push_back('%');
+            dest.push_back(t.flag);
+        } else if constexpr (t.padding.enabled()) {
+            format_flag_<t.flag, details::scoped_padder>(msg, parsed_.first[I].padding, dest);
+        } else {
+            format_flag_<t.flag, details::null_scoped_padder>(msg, parsed_.first[I].padding,
+                                                              dest);
+        }
+    }
+
+    // same as the flag formatters of pattern_formatter
+    template <char Flag, typename Padder>
+    void format_flag_(const details::log_msg &msg,
+                      const details::padding_info &padding,
+                      memory_buf_t &dest) {
+        using namespace details::fmt_helper;
+        namespace names = details::static_pattern;
+        [[maybe_unused]] const std::tm &tm_time = cached_tm_;
+
+        if constexpr (Flag == '+') {
+            format_full_(msg, dest);
+        } else if constexpr (Flag == 'v') {
+            Padder p(msg.payload.size(), padding, dest);
+            append_string_view(msg.payload, dest);
+        } else if constexpr (Flag == 't') {
+            Padder p(Padder::count_digits(msg.thread_id), padding, dest);
+            append_int(msg.thread_id, dest);
+        } else if constexpr (Flag == 'n') {
+            Padder p(msg.logger_name.size(), padding, dest);
+            append_string_view(msg.logger_name, dest);
+        } else if constexpr (Flag == 'l') {
+            const string_view_t &level_name = level::to_string_view(msg.level);
+            Padder p(level_name.size(), padding, dest);
+            append_string_view(level_name, dest);
+        } else if constexpr (Flag == 'L') {
+            string_view_t level_name{level::to_short_c_str(msg.level)};
+            Padder p(level_name.size(), padding, dest);
+            append_string_view(level_name, dest);
+        } else if constexpr (Flag == 'a') {
+            string_view_t field_value{names::days[static_cast<size_t>(tm_time.tm_wday)]};
+            Padder p(field_value.size(), padding, dest);
+            append_string_view(field_value, dest);
+        } else if constexpr (Flag == 'A') {
+            string_view_t field_value{names::full_days[static_cast<size_t>(tm_time.tm_wday)]};
+            Padder p(field_value.size(), padding, dest);
+            append_string_view(field_value, dest);
+        } else if constexpr (Flag == 'b' || Flag == 'h') {
+            string_view_t field_value{names::months[static_cast<size_t>(tm_time.tm_mon)]};
+            Padder p(field_value.size(), padding, dest);
+            append_string_view(field_value, dest);
+        } else if constexpr (Flag == 'B') {
+            string_view_t field_value{names::full_months[static_cast<size_t>(tm_time.tm_mon)]};
+            Padder p(field_value.size(), padding, dest);
+            append_string_view(field_value, dest);
+        } else if constexpr (Flag == 'c') {
+            Padder p(24, padding, dest);
+            append_string_view(names::days[static_cast<size_t>(tm_time.tm_wday)], dest);
+            dest.push_back(' ');
+            append_string_view(names::months[static_cast<size_t>(tm_time.tm_mon)], dest);
+            dest.push_back(' ');
+            append_int(tm_time.tm_mday, dest);
+            dest.push_back(' ');
+            pad2(tm_time.tm_hour, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_min, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_sec, dest);
+            dest.push_back(' ');
+            append_int(tm_time.tm_year + 1900, dest);
+        } else if constexpr (Flag == 'C') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_year % 100, dest);
+        } else if constexpr (Flag == 'Y') {
+            Padder p(4, padding, dest);
+            append_int(tm_time.tm_year + 1900, dest);
+        } else if constexpr (Flag == 'D' || Flag == 'x') {
+            Padder p(10, padding, dest);
+            pad2(tm_time.tm_mon + 1, dest);
+            dest.push_back('/');
+            pad2(tm_time.tm_mday, dest);
+            dest.push_back('/');
+            pad2(tm_time.tm_year % 100, dest);
+        } else if constexpr (Flag == 'm') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_mon + 1, dest);
+        } else if constexpr (Flag == 'd') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_mday, dest);
+        } else if constexpr (Flag == 'H') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_hour, dest);
+        } else if constexpr (Flag == 'I') {
+            Padder p(2, padding, dest);
+            pad2(to12h_(tm_time), dest);
+        } else if constexpr (Flag == 'M') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_min, dest);
+        } else if constexpr (Flag == 'S') {
+            Padder p(2, padding, dest);
+            pad2(tm_time.tm_sec, dest);
+        } else if constexpr (Flag == 'e') {
+            auto millis = time_fraction<std::chrono::milliseconds>(msg.time);
+            Padder p(3, padding, dest);
+            pad3(static_cast<uint32_t>(millis.count()), dest);
+        } else if constexpr (Flag == 'f') {
+            auto micros = time_fraction<std::chrono::microseconds>(msg.time);
+            Padder p(6, padding, dest);
+            pad6(static_cast<size_t>(micros.count()), dest);
+        } else if constexpr (Flag == 'F') {
+            auto ns = time_fraction<std::chrono::nanoseconds>(msg.time);
+            Padder p(9, padding, dest);
+            pad9(static_cast<size_t>(ns.count()), dest);
+        } else if constexpr (Flag == 'E') {
+            Padder p(10, padding, dest);
+            auto duration = msg.time.time_since_epoch();
+            append_int(std::chrono::duration_cast<std::chrono::seconds>(duration).count(), dest);
+        } else if constexpr (Flag == 'p') {
+            Padder p(2, padding, dest);
+            append_string_view(ampm_(tm_time), dest);
+        } else if constexpr (Flag == 'r') {
+            Padder p(11, padding, dest);
+            pad2(to12h_(tm_time), dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_min, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_sec, dest);
+            dest.push_back(' ');
+            append_string_view(ampm_(tm_time), dest);
+        } else if constexpr (Flag == 'R') {
+            Padder p(5, padding, dest);
+            pad2(tm_time.tm_hour, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_min, dest);
+        } else if constexpr (Flag == 'T' || Flag == 'X') {
+            Padder p(8, padding, dest);
+            pad2(tm_time.tm_hour, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_min, dest);
+            dest.push_back(':');
+            pad2(tm_time.tm_sec, dest);
+        } else if constexpr (Flag == 'z') {
+            Padder p(6, padding, dest);
+            auto total_minutes = timestamp_->utc_offset_minutes;
+            if (total_minutes < 0) {
+                total_minutes = -total_minutes;
+                dest.push_back('-');
+            } else {
+                dest.push_back('+');
+            }
+            pad2(total_minutes / 60, dest);
+            dest.push_back(':');
+            pad2(total_minutes % 60, dest);
+        } else if constexpr (Flag == 'P') {
+            const auto pid = static_cast<uint32_t>(details::os::pid());
+            Padder p(Padder::count_digits(pid), padding, dest);
+            append_int(pid, dest);
+        } else if constexpr (Flag == '^') {
+            msg.color_range_start = dest.size();
+        } else if constexpr (Flag == '$') {
+            msg.color_range_end = dest.size();
+        } else if constexpr (Flag == '@' || Flag == 's' || Flag == 'g' || Flag == '#' ||
+                             Flag == '!') {
+            if (msg.source.empty()) {
+                Padder p(0, padding, dest);
+                return;
+            }
+            format_source_<Flag, Padder>(msg, padding, dest);
+        } else if constexpr (Flag == 'o') {
+            format_elapsed_<std::chrono::milliseconds, Padder>(msg, padding, dest);
+        } else if constexpr (Flag == 'i') {
+            format_elapsed_<std::chrono::microseconds, Padder>(msg, padding, dest);
+        } else if constexpr (Flag == 'u') {
+            format_elapsed_<std::chrono::nanoseconds, Padder>(msg, padding, dest);
+        } else if constexpr (Flag == 'O') {
+            format_elapsed_<std::chrono::seconds, Padder>(msg, padding, dest);
+        }
+    #ifndef SPDLOG_NO_TLS
+        else if constexpr (Flag == '&') {
+            auto &mdc_map = mdc::get_context();
+            if (mdc_map.empty()) {
+                Padder p(0, padding, dest);
+            } else {
+                details::static_pattern::format_mdc<Padder>(mdc_map, padding, dest);
+            }
+        }
+    #endif
+    }
+
+    template <char Flag, typename Padder>
+    static void format_source_(const details::log_msg &msg,
+                               const details::padding_info &padding,
+                               memory_buf_t &dest) {
+        using namespace details::fmt_helper;
+        using traits = std::char_traits<char>;
+        if constexpr (Flag == '@') {
+            size_t text_size = padding.enabled() ? traits::length(msg.source.filename) +
+                                                       Padder::count_digits(msg.source.line) + 1
+                                                 : 0;
+            Padder p(text_size, padding, dest);
+            append_string_view(msg.source.filename, dest);
+            dest.push_back(':');
+            append_int(msg.source.line, dest);
+        } else if constexpr (Flag == 's') {
+            auto filename = details::static_pattern::short_filename(msg.source.filename);
+            size_t text_size = padding.enabled() ? traits::length(filename) : 0;
+            Padder p(text_size, padding, dest);
+            append_string_view(filename, dest);
+        } else if constexpr (Flag == 'g') {
+            size_t text_size = padding.enabled() ? traits::length(msg.source.filename) : 0;
+            Padder p(text_size, padding, dest);
+            append_string_view(msg.source.filename, dest);
+        } else if constexpr (Flag == '#') {
+            Padder p(Padder::count_digits(msg.source.line), padding, dest);
+            append_int(msg.source.line, dest);
+        } else {
+            size_t text_size = padding.enabled() ? traits::length(msg.source.funcname) : 0;
+            Padder p(text_size, padding, dest);
+            append_string_view(msg.source.funcname, dest);
+        }
+    }
+
+    template <typename Units, typename Padder>
+    void format_elapsed_(const details::log_msg &msg,
+                         const details::padding_info &padding,
+                         memory_buf_t &dest) {
+        auto delta = (std::max)(msg.time - last_message_time_, log_clock::duration::zero());
+        auto delta_count = static_cast<size_t>(std::chrono::duration_cast<Units>(delta).count());
+        Padder p(static_cast<size_t>(Padder::count_digits(delta_count)), padding, dest);
+        details::fmt_helper::append_int(delta_count, dest);
+    }
+
+    // [%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v, see details::full_formatter
+    void format_full_(const details::log_msg &msg, memory_buf_t &dest) {
+        using namespace details::fmt_helper;
+        dest.push_back('[');
+        append_string_view(details::to_string_view(timestamp_->datetime), dest);
+        dest.push_back('.');
+        pad3(static_cast<uint32_t>(time_fraction<std::chrono::milliseconds>(msg.time).count()),
+             dest);
+        append_string_view("] ", dest);
+        if (msg.logger_name.size() > 0) {
+            dest.push_back('[');
+            append_string_view(msg.logger_name, dest);
+            append_string_view("] ", dest);
+        }
+        dest.push_back('[');
+        msg.color_range_start = dest.size();
+        append_string_view(level::to_string_view(msg.level), dest);
+        msg.color_range_end = dest.size();
+        append_string_view("] ", dest);
+        if (!msg.source.empty()) {
+            dest.push_back('[');
+            append_string_view(details::static_pattern::short_filename(msg.source.filename),
+                               dest);
+            dest.push_back(':');
+            append_int(msg.source.line, dest);
+            append_string_view("] ", dest);
+        }
+    #ifndef SPDLOG_NO_TLS
+        auto &mdc_map = mdc::get_context();
+        if (!mdc_map.empty()) {
+            dest.push_back('[');
+            details::static_pattern::format_mdc<details::null_scoped_padder>(
+                mdc_map, details::padding_info{}, dest);
+            append_string_view("] ", dest);
+        }
+    #endif
+        append_string_view(msg.payload, dest);
+    }
+
+    static const char *ampm_(const std::tm &t) { return t.tm_hour >= 12 ? "PM" : "AM"; }
+    static int to12h_(const std::tm &t) { return t.tm_hour > 12 ? t.tm_hour - 12 : t.tm_hour; }
+};
+
+// the Pattern type of basic_static_pattern_formatter for a string literal
+    #define SPDLOG_STATIC_PATTERN(pattern)                                   \
+        [] {                                                                 \
+            struct spdlog_static_pattern {                                   \
+                static constexpr const char *value() { return pattern; }     \
+            };                                                               \
+            return spdlog_static_pattern{};                                  \
+        }()
+
+// e.g. make_static_pattern_formatter(SPDLOG_STATIC_PATTERN("[%H:%M:%S] %v"))
+template <typename Pattern>
+std::unique_ptr<basic_static_pattern_formatter<Pattern>> make_static_pattern_formatter(
+    Pattern,
+    pattern_time_type time_type = pattern_time_type::local,
+    std::string eol = spdlog::details::os::default_eol) {
+    return details::make_unique<basic_static_pattern_formatter<Pattern>>(time_type,
+                                                                         std::move(eol));
+}
+
+    #if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+// e.g. static_pattern_formatter<"[%H:%M:%S] %v">
+template <details::static_pattern::fixed_string Pattern>
+using static_pattern_formatter =
+    basic_static_pattern_formatter<details::static_pattern::fixed_pattern<Pattern>>;
+    #endif
+
+}  // namespace spdlog
+
+#endif
@@ -45,6 +45,17 @@
 // #define SPDLOG_NO_TLS
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to compute the local time without calling localtime_r() each time.
+// Each thread then keeps the utc offset of the time zone between its
+// transitions, and computes the local time from it without taking the time
+// zone lock of the libc (on posix, with thread local storage).
+// WARNING: a change of the time zone of the process (TZ) is then seen only
+// within a day.
+//
+// #define SPDLOG_FAST_LOCALTIME
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to avoid spdlog's usage of atomic log levels
 // Use only if your code never modifies a logger's log levels concurrently by
@@ -87,6 +98,16 @@
 // #define SPDLOG_USE_STD_FORMAT
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to accept format strings parsed at compile time, e.g.
+// logger->info(FMT_COMPILE("{} {}"), 1, 2), instead of at runtime on each call (needs C++17).
+// From C++20, the SPDLOG_LOGGER_* macros (e.g. SPDLOG_INFO) compile their format strings too,
+// which must then be string literals.
+// Ignored with SPDLOG_USE_STD_FORMAT.
+//
+// #define SPDLOG_COMPILED_FORMAT
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to enable wchar_t support (convert to utf8)
 //
@@ -5,7 +5,9 @@
     #error Please define SPDLOG_COMPILED_LIB to compile this file.
 #endif
 
+#include <spdlog/details/background_worker-inl.h>
 #include <spdlog/details/file_helper-inl.h>
+#include <spdlog/details/lz4_frame-inl.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink-inl.h>
 #include <spdlog/sinks/basic_file_sink-inl.h>
@@ -198,3 +198,406 @@ TEST_CASE("bad_tp", "[async]") {
     logger->info("Please throw an exception");
     REQUIRE(test_sink->msg_counter() == 0);
 }
+
+TEST_CASE("concurrent producers", "[async]") {
+    auto queue_type =
+        GENERATE(spdlog::async_queue_type::lock_free, spdlog::async_queue_type::per_thread);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    // the per thread queues are small, each producer has its own
+    bool per_thread = queue_type == spdlog::async_queue_type::per_thread;
+    size_t queue_size = per_thread ? 16 : 128;
+    size_t n_workers = per_thread ? 2 : 1;
+    size_t messages = 256;
+    size_t n_threads = 10;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, n_workers, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++) {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++) {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads) {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+        REQUIRE(tp->discard_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("queue overflow policies", "[async]") {
+    auto queue_type =
+        GENERATE(spdlog::async_queue_type::lock_free, spdlog::async_queue_type::per_thread,
+                 spdlog::async_queue_type::arena);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t queue_size = 4;
+    size_t messages = 1024;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, options);
+    auto overrun_logger = std::make_shared<spdlog::async_logger>(
+        "overrun", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    auto discard_logger = std::make_shared<spdlog::async_logger>(
+        "discard", test_sink, tp, spdlog::async_overflow_policy::discard_new);
+    for (size_t i = 0; i < messages; i++) {
+        overrun_logger->info("Hello message");
+        discard_logger->info("Hello message");
+    }
+    REQUIRE(test_sink->msg_counter() < messages * 2);
+    REQUIRE(tp->overrun_counter() > 0);
+    REQUIRE(tp->discard_counter() > 0);
+}
+
+TEST_CASE("per thread queues order", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    size_t messages = 64;
+    spdlog::thread_pool_options options;
+    options.queue_type = spdlog::async_queue_type::per_thread;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(8, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < messages; i++) {
+            logger->info("{}", i);
+        }
+        // messages of an exited thread are still delivered
+        std::thread([logger] { logger->info("from thread"); }).join();
+    }
+
+    auto lines = test_sink->lines();
+    REQUIRE(lines.size() == messages + 1);
+    for (size_t i = 0; i < messages; i++) {
+        REQUIRE(lines[i] == std::to_string(i));
+    }
+    REQUIRE(lines.back() == "from thread");
+}
+
+TEST_CASE("batch dequeue", "[async]") {
+    auto queue_type = GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free,
+                               spdlog::async_queue_type::per_thread);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    auto error_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    error_sink->set_level(spdlog::level::err);
+    size_t messages = 1024;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.max_batch_size = 64;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "as", spdlog::sinks_init_list{test_sink, error_sink}, tp,
+            spdlog::async_overflow_policy::block);
+        test_sink->set_delay(std::chrono::milliseconds(1));  // let the messages pile up
+        logger->info("0");
+        test_sink->set_delay(std::chrono::milliseconds::zero());
+        for (size_t i = 1; i < messages; i++) {
+            if (i % 100 == 0) {
+                logger->error("{}", i);
+            } else {
+                logger->info("{}", i);
+            }
+        }
+        logger->flush();
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+    REQUIRE(test_sink->batch_counter() > 0);
+    auto lines = test_sink->lines();
+    for (size_t i = 0; i < lines.size(); i++) {
+        REQUIRE(lines[i] == std::to_string(i));
+    }
+    REQUIRE(error_sink->msg_counter() == 10);
+}
+
+TEST_CASE("batch dequeue multi-workers", "[async]") {
+    auto queue_type = GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free);
+    prepare_logdir();
+    size_t messages = 1024 * 10;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.max_batch_size = 16;
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    {
+        auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename, true);
+        auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 10, options);
+        auto logger =
+            std::make_shared<spdlog::async_logger>("as", std::move(file_sink), std::move(tp));
+
+        for (size_t j = 0; j < messages; j++) {
+            logger->info("Hello message #{}", j);
+        }
+    }
+    require_message_count(TEST_FILENAME, messages);
+}
+
+TEST_CASE("arena queue", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    size_t queue_size = 64;
+    size_t messages = 256;
+    size_t n_threads = 10;
+    spdlog::thread_pool_options options;
+    options.queue_type = spdlog::async_queue_type::arena;
+    options.max_batch_size = GENERATE(size_t{1}, size_t{16});
+    std::string long_payload(10000, 'x');
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 2, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        // payloads bigger than a queue slot
+        logger->info(long_payload);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++) {
+            threads.emplace_back([logger, messages] {
+                for (size_t j = 0; j < messages; j++) {
+                    logger->info("Hello message #{}", j);
+                }
+            });
+        }
+
+        for (auto &t : threads) {
+            t.join();
+        }
+        logger->flush();
+        REQUIRE(tp->overrun_counter() == 0);
+        REQUIRE(tp->discard_counter() == 0);
+    }
+
+    REQUIRE(test_sink->msg_counter() == messages * n_threads + 1);
+    REQUIRE(test_sink->flush_counter() == 1);
+    REQUIRE(test_sink->lines()[0] == long_payload);
+}
+
+TEST_CASE("logger handles", "[async]") {
+    auto queue_type = GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free,
+                               spdlog::async_queue_type::arena);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 64;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.logger_handles = true;
+    options.max_batch_size = 8;
+
+    auto tp = std::make_shared<spdlog::details::thread_pool>(messages, 2, options);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                         spdlog::async_overflow_policy::block);
+    REQUIRE(tp.use_count() == 2);
+    for (size_t i = 0; i < messages; i++) {
+        logger->info("Hello message #{}", i);
+    }
+    logger->flush();
+    // the queued messages don't hold references to the logger
+    REQUIRE(logger.use_count() == 1);
+
+    // destroying the logger waits until all its messages were logged
+    logger.reset();
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+    REQUIRE(tp.use_count() == 1);
+}
+
+TEST_CASE("logger handles clone", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::thread_pool_options options;
+    options.logger_handles = true;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+    auto cloned = logger->clone("cloned");
+    // the other logger shares the pool but uses overrun_oldest. drain msgs must not get lost
+    auto overrun_logger = std::make_shared<spdlog::async_logger>(
+        "overrun", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+    std::atomic<bool> stop{false};
+    std::thread overrun_thread([&] {
+        while (!stop) {
+            overrun_logger->info("overrun");
+        }
+    });
+
+    for (int i = 0; i < 100; i++) {
+        logger->info("Hello");
+        cloned->info("Hello");
+    }
+    logger.reset();
+    cloned->info("Still here");
+    cloned.reset();
+    stop = true;
+    overrun_thread.join();
+    REQUIRE(test_sink->msg_counter() > 0);
+}
+
+// releases its reference to a logger when it logs, on the worker
+class releasing_sink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    std::shared_ptr<spdlog::async_logger> held;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &) override { held.reset(); }
+    void flush_() override {}
+};
+
+TEST_CASE("logger handles destroyed by a worker", "[async]") {
+    auto workers = GENERATE(1, 2);
+    auto sharded = GENERATE(false, true);
+    spdlog::thread_pool_options options;
+    options.logger_handles = true;
+    options.sharded = sharded;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(128, workers, options);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto releasing = std::make_shared<releasing_sink>();
+    releasing->held = std::make_shared<spdlog::async_logger>("held", test_sink, tp);
+    releasing->held->info("maybe dropped");
+
+    // the worker destroys the held logger: it must not wait for itself
+    auto logger = std::make_shared<spdlog::async_logger>("releasing", releasing, tp);
+    logger->info("release");
+    logger.reset();
+    REQUIRE(releasing->held == nullptr);
+
+    // the pool still works
+    auto other = std::make_shared<spdlog::async_logger>("other", test_sink, tp);
+    other->info("logged");
+    other.reset();
+    REQUIRE(test_sink->msg_counter() >= 1);
+    REQUIRE(test_sink->msg_counter() <= 2);
+}
+
+TEST_CASE("sharded queues", "[async]") {
+    auto queue_type = GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free,
+                               spdlog::async_queue_type::arena);
+    auto logger_handles = GENERATE(false, true);
+    size_t messages = 64;
+    size_t workers = 4;
+    std::vector<std::shared_ptr<spdlog::sinks::test_sink_mt>> test_sinks;
+    for (size_t i = 0; i < workers; i++) {
+        test_sinks.push_back(std::make_shared<spdlog::sinks::test_sink_mt>());
+        test_sinks.back()->set_pattern("%v");
+    }
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.logger_handles = logger_handles;
+    options.sharded = true;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, workers, options);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < workers; i++) {
+            threads.emplace_back([&, i] {
+                // two loggers sharing a sink post to the same worker: their messages stay in order
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sinks[i], tp);
+                auto other = std::make_shared<spdlog::async_logger>("other", test_sinks[i], tp);
+                for (size_t j = 0; j < messages; j += 2) {
+                    logger->info("{}", j);
+                    other->info("{}", j + 1);
+                }
+                logger->flush();
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        REQUIRE(tp->overrun_counter() == 0);
+        REQUIRE(tp->discard_counter() == 0);
+    }
+
+    for (auto &test_sink : test_sinks) {
+        auto lines = test_sink->lines();
+        REQUIRE(lines.size() == messages);
+        for (size_t i = 0; i < messages; i++) {
+            REQUIRE(lines[i] == std::to_string(i));
+        }
+        REQUIRE(test_sink->flush_counter() == 1);
+    }
+}
+
+TEST_CASE("wait policies", "[async]") {
+    auto queue_type =
+        GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free,
+                 spdlog::async_queue_type::per_thread, spdlog::async_queue_type::arena);
+    auto wait_policy =
+        GENERATE(spdlog::async_wait_policy::block, spdlog::async_wait_policy::spin_yield_park,
+                 spdlog::async_wait_policy::busy_spin);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    size_t messages = 1024;
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.wait_policy = wait_policy;
+    options.max_batch_size = 16;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 2, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < messages; i++) {
+            logger->info("Hello message #{}", i);
+            if (i % 256 == 0) {
+                // let the workers go past the spinning phase
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        logger->flush();
+    }
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->flush_counter() == 1);
+}
+
+TEST_CASE("deferred formatting", "[async]") {
+    auto queue_type =
+        GENERATE(spdlog::async_queue_type::mutex, spdlog::async_queue_type::lock_free,
+                 spdlog::async_queue_type::per_thread, spdlog::async_queue_type::arena);
+    auto max_batch_size = GENERATE(1, 16);
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    spdlog::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.max_batch_size = max_batch_size;
+    size_t errors = 0;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp);
+        logger->set_deferred_formatting(true);
+        logger->set_error_handler([&errors](const std::string &) { errors++; });
+
+        std::string text("text");
+        logger->info("{} {} {:.2f} {} {}", 1, -2L, 3.14159, true, 'c');
+        // the arguments are copied: they can change right after the call
+        logger->info("{} {} {}", text, "literal", spdlog::string_view_t(text.data(), 2));
+        text = "changed";
+        logger->info("{}", std::string("temporary"));
+        const char *null_str = nullptr;
+        logger->info("{}", static_cast<const void *>(null_str));
+        logger->info("no args");
+        logger->info("");
+        // reported on the worker, the next messages are still logged
+        logger->info(SPDLOG_FMT_RUNTIME("{} {}"), 1);
+        logger->info("{:>5}", 42);
+        // formatted right away while the backtrace is enabled
+        logger->enable_backtrace(4);
+        logger->info("{}", 43);
+        logger->disable_backtrace();
+        logger->info("{}", 44);
+    }
+
+    auto lines = test_sink->lines();
+    std::vector<std::string> expected = {
+        "1 -2 3.14 true c", "text literal te", "temporary", "0x0", "no args", "", "   42", "43",
+        "44"};
+    REQUIRE(lines == expected);
+    REQUIRE(errors == 1);
+}
@@ -0,0 +1,66 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+
+// format strings parsed at compile time, with SPDLOG_COMPILED_FORMAT set for the whole build.
+// built in C++17 by the spdlog-utests-compiled-format target, as FMT_COMPILE falls back to
+// FMT_STRING before.
+
+#include "includes.h"
+
+#if defined(SPDLOG_COMPILED_FORMAT) && !defined(SPDLOG_USE_STD_FORMAT)
+
+static std::shared_ptr<spdlog::logger> ostream_logger(std::ostringstream &oss) {
+    auto oss_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    auto logger = std::make_shared<spdlog::logger>("compiled", oss_sink);
+    logger->set_pattern("%v");
+    logger->set_level(spdlog::level::trace);
+    return logger;
+}
+
+TEST_CASE("compiled format macros", "[compiled_format]") {
+    std::ostringstream oss;
+    auto logger = ostream_logger(oss);
+    using spdlog::details::os::default_eol;
+
+    SPDLOG_LOGGER_INFO(logger, "Test message {} {:.2f} {}", 1, 2.5, std::string("three"));
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("Test message 1 2.50 three{}", default_eol));
+
+    oss.str("");
+    SPDLOG_LOGGER_DEBUG(logger, "Test message without args");
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("Test message without args{}", default_eol));
+
+    oss.str("");
+    logger->set_level(spdlog::level::info);
+    SPDLOG_LOGGER_DEBUG(logger, "Test message {}", 4);
+    REQUIRE(oss.str().empty());
+}
+
+TEST_CASE("compiled format logger api", "[compiled_format]") {
+    std::ostringstream oss;
+    auto logger = ostream_logger(oss);
+    using spdlog::details::os::default_eol;
+    #if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+    // the compiled overloads are taken
+    auto compiled = FMT_COMPILE("{}");
+    REQUIRE(spdlog::is_compiled_format_string<decltype(compiled)>::value);
+    #endif
+
+    logger->warn(FMT_COMPILE("{:>5}|{:<3}|{}"), 42, "ab", 'c');
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("   42|ab |c{}", default_eol));
+
+    oss.str("");
+    logger->log(spdlog::level::err, FMT_COMPILE("no args"));
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("no args{}", default_eol));
+}
+
+TEST_CASE("compiled format size hint", "[compiled_format]") {
+    using spdlog::details::format_size_hint;
+    REQUIRE(format_size_hint(spdlog::string_view_t("abc")) == 3);
+    REQUIRE(format_size_hint(spdlog::string_view_t("{}"), std::string(100, 'x')) == 102);
+    REQUIRE(format_size_hint(spdlog::string_view_t("{}"), 123) >= 2 + 3);
+    REQUIRE(format_size_hint(spdlog::string_view_t("{}"), -1234567.0) >= 2 + 8);
+}
+
+#endif
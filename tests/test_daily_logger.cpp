@@ -3,6 +3,7 @@
  * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
  */
 #include "includes.h"
+#include "spdlog/sinks/hourly_file_sink.h"
 
 #ifdef SPDLOG_USE_STD_FORMAT
 using filename_memory_buf_t = std::basic_string<spdlog::filename_t::value_type>;
@@ -171,3 +172,62 @@ TEST_CASE("daily_logger rotate", "[daily_file_sink]") {
     test_rotate(days_to_run, 11, 10);
     test_rotate(days_to_run, 20, 10);
 }
+
+TEST_CASE("hybrid_rotating_file_sink::calc_filename", "[hybrid_rotating_file_sink]") {
+    using sink_type = spdlog::sinks::hybrid_rotating_file_sink_st;
+    std::tm tm{};
+    tm.tm_year = 124;
+    tm.tm_mon = 0;
+    tm.tm_mday = 2;
+    REQUIRE(sink_type::calc_filename(SPDLOG_FILENAME_T("logs/hybrid.txt"), tm, 0) ==
+            SPDLOG_FILENAME_T("logs/hybrid_2024-01-02.txt"));
+    REQUIRE(sink_type::calc_filename(SPDLOG_FILENAME_T("logs/hybrid.txt"), tm, 3) ==
+            SPDLOG_FILENAME_T("logs/hybrid_2024-01-02.3.txt"));
+}
+
+TEST_CASE("hybrid_rotating_file_sink size", "[hybrid_rotating_file_sink]") {
+    using sink_type = spdlog::sinks::hybrid_rotating_file_sink_st;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/hybrid.txt");
+    auto tm = spdlog::details::os::localtime();
+    {
+        sink_type sink{basename, 100};
+        sink.set_pattern("%v");
+        // 7 messages per file
+        for (int i = 0; i < 30; i++) {
+            sink.log(create_msg(std::chrono::seconds(0)));
+        }
+        REQUIRE(sink.filename() == sink_type::calc_filename(basename, tm, 4));
+        REQUIRE(sink.next_rotation_time() > spdlog::log_clock::now());
+        REQUIRE(sink.next_rotation_time() <= spdlog::log_clock::now() + std::chrono::hours(24));
+    }
+    REQUIRE(count_files("test_logs") == 5);
+
+    // appends to the last file after a restart
+    sink_type sink{basename, 100};
+    REQUIRE(sink.filename() == sink_type::calc_filename(basename, tm, 4));
+}
+
+TEST_CASE("hybrid_rotating_file_sink time", "[hybrid_rotating_file_sink]") {
+    using sink_type =
+        spdlog::sinks::hybrid_rotating_file_sink<spdlog::details::null_mutex,
+                                                 spdlog::sinks::hourly_filename_calculator>;
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/hybrid.txt");
+    sink_type sink{basename, 1024 * 1024, std::chrono::minutes(60), 3};
+
+    // simulate messages with 1 hour intervals
+    for (int i = 0; i < 5; i++) {
+        auto msg = create_msg(std::chrono::seconds{3600 * i});
+        sink.log(msg);
+        REQUIRE(sink.next_rotation_time() > msg.time);
+        REQUIRE(sink.next_rotation_time() <= msg.time + std::chrono::hours(1));
+    }
+    REQUIRE(count_files("test_logs") == 3);
+
+    REQUIRE_THROWS_AS(sink_type(basename, 1024, std::chrono::minutes(7)), spdlog::spdlog_ex);
+    // the daily filenames can't tell the hours apart
+    REQUIRE_THROWS_AS(spdlog::sinks::hybrid_rotating_file_sink_st(basename, 1024,
+                                                                  std::chrono::minutes(60)),
+                      spdlog::spdlog_ex);
+}
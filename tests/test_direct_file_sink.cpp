@@ -0,0 +1,64 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#ifdef __linux__
+
+    #include "includes.h"
+    #include "spdlog/sinks/direct_file_sink.h"
+
+    #define DIRECT_LOG "test_logs/direct_log"
+
+using spdlog::details::os::default_eol;
+
+static std::string expected_lines(int first, int last) {
+    std::string expected;
+    for (int i = first; i < last; i++) {
+        expected += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+    }
+    return expected;
+}
+
+TEST_CASE("direct_file_sink", "[direct_file_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(DIRECT_LOG);
+    {
+        // a small buffer, to write full buffers too
+        auto sink = std::make_shared<spdlog::sinks::direct_file_sink_st>(filename, true, 8192);
+        spdlog::logger logger("direct_logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 1000; i++) {
+            logger.info("Test message {}", i);
+        }
+        // the file has its real size after a flush
+        logger.flush();
+        REQUIRE(file_contents(DIRECT_LOG) == expected_lines(0, 1000));
+        for (int i = 1000; i < 1010; i++) {
+            logger.info("Test message {}", i);
+        }
+        logger.flush();
+        REQUIRE(file_contents(DIRECT_LOG) == expected_lines(0, 1010));
+        logger.info("Test message 1010");
+    }
+    REQUIRE(file_contents(DIRECT_LOG) == expected_lines(0, 1011));
+
+    // appends after the partial block at the end
+    {
+        auto sink = std::make_shared<spdlog::sinks::direct_file_sink_st>(filename, false, 8192);
+        spdlog::logger logger("direct_logger", sink);
+        logger.set_pattern("%v");
+        for (int i = 1011; i < 2000; i++) {
+            logger.info("Test message {}", i);
+        }
+        sink->sync();
+    }
+    REQUIRE(file_contents(DIRECT_LOG) == expected_lines(0, 2000));
+}
+
+TEST_CASE("direct_file buffer size", "[direct_file_sink]") {
+    REQUIRE(spdlog::details::direct_file(0).buffer_size() == 4096);
+    REQUIRE(spdlog::details::direct_file(5000).buffer_size() == 8192);
+    REQUIRE(spdlog::details::direct_file(8192).buffer_size() == 8192);
+}
+
+#endif
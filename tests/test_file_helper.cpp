@@ -167,3 +167,48 @@ TEST_CASE("file_helper_open", "[file_helper]") {
     target_filename += SPDLOG_FILENAME_T("/invalid");
     REQUIRE_THROWS_AS(helper.open(target_filename), spdlog::spdlog_ex);
 }
+
+TEST_CASE("file_helper_write_buffer", "[file_helper]") {
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T(TEST_FILENAME);
+    file_helper helper;
+    helper.set_write_buffer_size(64);
+    helper.open(target_filename);
+
+    helper.write(spdlog::string_view_t("0123456789"));
+    REQUIRE(get_filesize(TEST_FILENAME) == 0);
+    REQUIRE(helper.size() == 10);
+
+    // fills the buffer: the first 10 bytes are written
+    std::string block(60, 'a');
+    helper.write(spdlog::string_view_t(block));
+    REQUIRE(get_filesize(TEST_FILENAME) == 10);
+    REQUIRE(helper.size() == 70);
+
+    // larger than the buffer: written right away, after the buffered bytes
+    std::string large(100, 'b');
+    helper.write(spdlog::string_view_t(large));
+    REQUIRE(get_filesize(TEST_FILENAME) == 170);
+
+    helper.write(spdlog::string_view_t("end"));
+    helper.flush();
+    REQUIRE(file_contents(TEST_FILENAME) == "0123456789" + block + large + "end");
+}
+
+TEST_CASE("file_event_handlers_write_buffer", "[file_helper]") {
+    prepare_logdir();
+    spdlog::file_event_handlers handlers;
+    handlers.after_open = [](spdlog::filename_t, std::FILE *fstream) {
+        fputs("after_open\n", fstream);
+    };
+    handlers.before_close = [](spdlog::filename_t, std::FILE *fstream) {
+        fputs("before_close\n", fstream);
+    };
+    {
+        file_helper helper{handlers};
+        helper.set_write_buffer_size(1024);
+        helper.open(SPDLOG_FILENAME_T(TEST_FILENAME));
+        helper.write(spdlog::string_view_t("message\n"));
+    }
+    REQUIRE(file_contents(TEST_FILENAME) == "after_open\nmessage\nbefore_close\n");
+}
@@ -141,3 +141,117 @@ TEST_CASE("rotating_file_logger4", "[rotating_logger]") {
     REQUIRE(get_filesize(ROTATING_LOG) > 0);
     REQUIRE(get_filesize(ROTATING_LOG ".1") > 0);
 }
+
+// rotation with buffered writes
+TEST_CASE("rotating_file_logger5", "[rotating_logger]") {
+    prepare_logdir();
+    size_t max_size = 1024 * 10;
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    spdlog::file_sink_options options;
+    options.write_buffer_size = 4096;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+        basename, max_size, 2, false, spdlog::file_event_handlers{}, options);
+    auto logger = std::make_shared<spdlog::logger>("rotating_sink_logger", sink);
+
+    for (int i = 0; i < 10; ++i) {
+        logger->info("Test message {}", i);
+    }
+    logger->flush();
+    require_message_count(ROTATING_LOG, 10);
+
+    for (int i = 0; i < 1000; i++) {
+        logger->info("Test message {}", i);
+    }
+    logger->flush();
+    REQUIRE(get_filesize(ROTATING_LOG) <= max_size);
+    REQUIRE(get_filesize(ROTATING_LOG ".1") <= max_size);
+    REQUIRE(get_filesize(ROTATING_LOG ".1") > max_size / 2);
+}
+
+// the older files are renamed in the background
+TEST_CASE("rotating_file_logger_background", "[rotating_logger]") {
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    using spdlog::details::os::default_eol;
+    auto line = [](int i) { return spdlog::fmt_lib::format("Test message {}{}", i, default_eol); };
+    // room for 2 lines per file
+    size_t max_size = line(0).size() * 2;
+    spdlog::file_sink_options options;
+    options.background_rotation = true;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+        basename, max_size, 3, false, spdlog::file_event_handlers{}, options);
+    spdlog::logger logger("rotating_sink_logger", sink);
+    logger.set_pattern("%v");
+
+    for (int i = 0; i < 10; ++i) {
+        logger.info("Test message {}", i);
+    }
+    logger.flush();
+    sink->wait_rotation();
+    REQUIRE(file_contents(ROTATING_LOG) == line(8) + line(9));
+    REQUIRE(file_contents(ROTATING_LOG ".1") == line(6) + line(7));
+    REQUIRE(file_contents(ROTATING_LOG ".2") == line(4) + line(5));
+    REQUIRE(file_contents(ROTATING_LOG ".3") == line(2) + line(3));
+    REQUIRE(count_files("test_logs") == 4);
+}
+
+TEST_CASE("rotating_file_logger_background_leftovers", "[rotating_logger]") {
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    auto write_file = [](const char *filename, const std::string &contents) {
+        std::ofstream(filename, std::ios::binary) << contents;
+    };
+    // a previous run was killed before its last two background rotations were finished
+    write_file(ROTATING_LOG ".1", "old\n");
+    write_file(ROTATING_LOG ".rotating1", "first\n");
+    write_file(ROTATING_LOG ".rotating2", "second\n");
+
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    spdlog::file_sink_options options;
+    options.background_rotation = true;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+        basename, 1024, 3, false, spdlog::file_event_handlers{}, options);
+    spdlog::logger logger("rotating_sink_logger", sink);
+    logger.set_pattern("%v");
+    logger.info("current");
+    // a rotation of this run doesn't overwrite the leftovers still being shifted
+    sink->rotate_now();
+    sink->wait_rotation();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(ROTATING_LOG ".1") == std::string("current") + default_eol);
+    REQUIRE(file_contents(ROTATING_LOG ".2") == "second\n");
+    REQUIRE(file_contents(ROTATING_LOG ".3") == "first\n");
+    REQUIRE(count_files("test_logs") == 4);
+}
+
+TEST_CASE("index_rotating_file_logger", "[rotating_logger]") {
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(ROTATING_LOG);
+    using spdlog::details::os::default_eol;
+    auto line = [](int i) { return spdlog::fmt_lib::format("Test message {}{}", i, default_eol); };
+    // room for 2 lines per file
+    size_t max_size = line(0).size() * 2;
+    {
+        auto logger = spdlog::index_rotating_logger_mt("logger", basename, max_size, 3);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 10; ++i) {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop(logger->name());
+    }
+    // the last rotated files have the highest indexes
+    REQUIRE(file_contents(ROTATING_LOG) == line(8) + line(9));
+    REQUIRE(file_contents(ROTATING_LOG ".4") == line(6) + line(7));
+    REQUIRE(file_contents(ROTATING_LOG ".3") == line(4) + line(5));
+    REQUIRE(file_contents(ROTATING_LOG ".2") == line(2) + line(3));
+    REQUIRE(count_files("test_logs") == 4);
+
+    // continues after the last index, and deletes the older files
+    auto sink = std::make_shared<spdlog::sinks::index_rotating_file_sink_st>(basename, max_size,
+                                                                              2, true);
+    REQUIRE(sink->next_index() == 6);
+    REQUIRE(file_contents(ROTATING_LOG ".5") == line(8) + line(9));
+    REQUIRE(file_contents(ROTATING_LOG ".4") == line(6) + line(7));
+    REQUIRE(count_files("test_logs") == 3);
+}
@@ -80,3 +80,18 @@ TEST_CASE("pad9", "[fmt_helper]") {
     test_pad9(123456789, "123456789");
     test_pad9(1234567891, "1234567891");
 }
+
+TEST_CASE("pad digits", "[fmt_helper]") {
+    using spdlog::fmt_lib::format;
+    for (int i = 0; i < 1000000; i += 997) {
+        auto n = static_cast<std::size_t>(i) * 1001;
+        test_pad9(n, format("{:09}", n).c_str());
+        test_pad6(n % 1000000, format("{:06}", n % 1000000).c_str());
+        test_pad3(static_cast<uint32_t>(n % 1000), format("{:03}", n % 1000).c_str());
+        test_pad2(static_cast<int>(n % 100), format("{:02}", n % 100).c_str());
+    }
+    test_pad6(999999, "999999");
+    test_pad6(1000000, "1000000");
+    test_pad9(999999999, "999999999");
+    test_pad9(1000000000, "1000000000");
+}
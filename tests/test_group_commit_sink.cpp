@@ -0,0 +1,76 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/group_commit_file_sink.h"
+
+#include <thread>
+
+#define GROUP_COMMIT_LOG "test_logs/group_commit_log.txt"
+
+using spdlog::details::os::default_eol;
+
+TEST_CASE("group_commit_sink", "[group_commit_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(GROUP_COMMIT_LOG);
+    auto sink = std::make_shared<spdlog::sinks::group_commit_file_sink>(filename, true);
+    spdlog::logger logger("group_commit", sink);
+    logger.set_pattern("%v");
+    for (int i = 0; i < 10; i++) {
+        logger.info("Test message {}", i);
+    }
+    // a single thread gets a sync per message, whose lines are written when it returns
+    REQUIRE(sink->sync_count() == 10);
+    REQUIRE(count_lines(GROUP_COMMIT_LOG) == 10);
+    REQUIRE(file_contents(GROUP_COMMIT_LOG).find(
+                spdlog::fmt_lib::format("Test message 9{}", default_eol)) != std::string::npos);
+    sink->wait_durable();
+    REQUIRE(sink->sync_count() == 10);
+}
+
+TEST_CASE("group_commit_sink durable_level", "[group_commit_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(GROUP_COMMIT_LOG);
+    spdlog::sinks::group_commit_config config;
+    config.durable_level = spdlog::level::err;
+    auto logger = spdlog::group_commit_logger_mt("group_commit", filename, true, config);
+    auto sink =
+        std::static_pointer_cast<spdlog::sinks::group_commit_file_sink>(logger->sinks()[0]);
+    logger->info("Test message 1");
+    logger->warn("Test message 2");
+    REQUIRE(sink->sync_count() == 0);
+    logger->error("Test message 3");
+    REQUIRE(sink->sync_count() == 1);
+    REQUIRE(count_lines(GROUP_COMMIT_LOG) == 3);
+    logger->info("Test message 4");
+    sink->wait_durable();
+    REQUIRE(sink->sync_count() == 2);
+    REQUIRE(count_lines(GROUP_COMMIT_LOG) == 4);
+}
+
+TEST_CASE("group_commit_sink multithreaded", "[group_commit_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(GROUP_COMMIT_LOG);
+    spdlog::sinks::group_commit_config config;
+    config.commit_window = std::chrono::milliseconds(1);
+    auto sink = std::make_shared<spdlog::sinks::group_commit_file_sink>(filename, true, config);
+    spdlog::logger logger("group_commit", sink);
+    logger.set_pattern("%v");
+
+    const int n_threads = 8, n_messages = 50;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < n_messages; i++) {
+                logger.info("Thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(count_lines(GROUP_COMMIT_LOG) == static_cast<size_t>(n_threads * n_messages));
+    // the syncs are shared by the threads
+    REQUIRE(sink->sync_count() < static_cast<uint64_t>(n_threads * n_messages));
+}
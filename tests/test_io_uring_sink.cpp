@@ -0,0 +1,138 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#ifdef __linux__
+
+    #include "includes.h"
+    #include "spdlog/sinks/io_uring_file_sink.h"
+
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    #define IO_URING_LOG "test_logs/io_uring_log"
+
+using spdlog::details::os::default_eol;
+
+static std::string expected_lines(int count) {
+    std::string expected;
+    for (int i = 0; i < count; i++) {
+        expected += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+    }
+    return expected;
+}
+
+static void test_io_uring_sink(const spdlog::sinks::io_uring_file_sink_config &config,
+                               int count) {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(IO_URING_LOG);
+    auto sink = std::make_shared<spdlog::sinks::io_uring_file_sink_mt>(filename, true, config);
+    spdlog::logger logger("io_uring_logger", sink);
+    logger.set_pattern("%v");
+    for (int i = 0; i < count; i++) {
+        logger.info("Test message {}", i);
+    }
+    sink->drain();
+
+    auto expected = expected_lines(count);
+    REQUIRE(file_contents(IO_URING_LOG) == expected);
+    auto stats = sink->stats();
+    REQUIRE(stats.in_flight == 0);
+    REQUIRE(stats.bytes_written == expected.size());
+    REQUIRE(stats.completed_writes ==
+            (expected.size() + config.buffer_size - 1) / config.buffer_size);
+}
+
+TEST_CASE("io_uring_file_sink", "[io_uring_file_sink]") {
+    spdlog::sinks::io_uring_file_sink_config config;
+    test_io_uring_sink(config, 1000);
+}
+
+TEST_CASE("io_uring_file_sink recycles buffers", "[io_uring_file_sink]") {
+    spdlog::sinks::io_uring_file_sink_config config;
+    config.buffer_size = 100;
+    config.max_in_flight = 2;
+    test_io_uring_sink(config, 1000);
+}
+
+TEST_CASE("io_uring_file_sink without io_uring", "[io_uring_file_sink]") {
+    spdlog::sinks::io_uring_file_sink_config config;
+    config.buffer_size = 100;
+    config.use_io_uring = false;
+    test_io_uring_sink(config, 1000);
+}
+
+TEST_CASE("io_uring_file_sink flush and sync", "[io_uring_file_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(IO_URING_LOG);
+    spdlog::sinks::io_uring_file_sink_config config;
+    config.sync_interval = std::chrono::milliseconds(1);
+    {
+        auto logger = spdlog::io_uring_logger_mt("io_uring_logger", filename, true, config);
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        logger->info("Test message {}", 1);
+        logger->flush();
+        auto sink = std::static_pointer_cast<spdlog::sinks::io_uring_file_sink_mt>(
+            logger->sinks().front());
+        sink->drain();
+        REQUIRE(sink->stats().completed_syncs == 1);
+        REQUIRE(file_contents(IO_URING_LOG) == expected_lines(2));
+        spdlog::drop_all();
+    }
+
+    // appends, and writes what's left when closing
+    {
+        spdlog::sinks::io_uring_file_sink_mt sink(filename, false);
+        sink.set_pattern("%v");
+        sink.log(spdlog::details::log_msg("test", spdlog::level::info, "Test message 2"));
+    }
+    REQUIRE(file_contents(IO_URING_LOG) == expected_lines(3));
+}
+
+// make io_uring_enter fail on the rings of the process, by replacing their fds with /dev/null
+static void break_io_uring_rings() {
+    DIR *dir = ::opendir("/proc/self/fd");
+    REQUIRE(dir != nullptr);
+    int null_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    REQUIRE(null_fd >= 0);
+    while (auto *entry = ::readdir(dir)) {
+        char target[64] = {};
+        auto path = std::string("/proc/self/fd/") + entry->d_name;
+        if (::readlink(path.c_str(), target, sizeof(target) - 1) > 0 &&
+            std::string(target) == "anon_inode:[io_uring]") {
+            ::dup2(null_fd, std::atoi(entry->d_name));
+        }
+    }
+    ::close(null_fd);
+    ::closedir(dir);
+}
+
+TEST_CASE("io_uring_file_sink io_uring failure", "[io_uring_file_sink]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(IO_URING_LOG);
+    spdlog::sinks::io_uring_file_sink_config config;
+    config.buffer_size = 100;
+    {
+        auto sink = std::make_shared<spdlog::sinks::io_uring_file_sink_mt>(filename, true, config);
+        if (!sink->uses_io_uring()) {
+            return;
+        }
+        spdlog::logger logger("io_uring_logger", sink);
+        logger.set_pattern("%v");
+        logger.info("Test message {}", 0);
+        sink->drain();
+        break_io_uring_rings();
+        // the buffers the kernel didn't take are written with pwrite(), and none is waited for
+        for (int i = 1; i < 1000; i++) {
+            logger.info("Test message {}", i);
+        }
+        sink->drain();
+        REQUIRE(sink->stats().in_flight == 0);
+    }
+    REQUIRE(file_contents(IO_URING_LOG) == expected_lines(1000));
+}
+
+#endif
@@ -0,0 +1,360 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/details/lz4_frame.h"
+
+#include <random>
+
+#define LZ4_LOG "test_logs/lz4_log.txt.lz4"
+
+using spdlog::details::os::default_eol;
+
+static uint32_t read32_le(const std::string &s, size_t pos) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4; i++) {
+        v |= static_cast<uint32_t>(static_cast<unsigned char>(s[pos + i])) << (8 * i);
+    }
+    return v;
+}
+
+// decode the concatenated lz4 frames in data. throws on corrupted data.
+static std::string lz4_decode(const std::string &data) {
+    auto check = [](bool ok) {
+        if (!ok) {
+            throw std::runtime_error("corrupted lz4 frame");
+        }
+    };
+    std::string out;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        check(pos + 7 <= data.size() && read32_le(data, pos) == 0x184D2204);
+        check(data[pos + 4] == 0x60);
+        check(static_cast<unsigned char>(data[pos + 6]) ==
+              ((spdlog::details::xxh32(data.data() + pos + 4, 2) >> 8) & 0xFF));
+        pos += 7;
+        for (;;) {
+            check(pos + 4 <= data.size());
+            auto block_size = read32_le(data, pos);
+            pos += 4;
+            if (block_size == 0) {
+                break;  // end mark
+            }
+            auto size = block_size & 0x7FFFFFFF;
+            check(pos + size <= data.size());
+            if (block_size & 0x80000000) {
+                out.append(data, pos, size);
+                pos += size;
+                continue;
+            }
+            auto end = pos + size;
+            while (pos < end) {
+                auto token = static_cast<unsigned char>(data[pos++]);
+                auto read_length = [&](size_t length) {
+                    if (length == 15) {
+                        unsigned char b;
+                        do {
+                            b = static_cast<unsigned char>(data[pos++]);
+                            length += b;
+                        } while (b == 255);
+                    }
+                    return length;
+                };
+                auto literals = read_length(token >> 4);
+                out.append(data, pos, literals);
+                pos += literals;
+                if (pos == end) {
+                    break;
+                }
+                size_t offset = static_cast<unsigned char>(data[pos]);
+                offset |= static_cast<size_t>(static_cast<unsigned char>(data[pos + 1])) << 8;
+                pos += 2;
+                check(offset > 0 && offset <= out.size());
+                auto match = read_length(token & 15) + 4;
+                for (size_t i = 0; i < match; i++) {
+                    out.push_back(out[out.size() - offset]);
+                }
+            }
+            check(pos == end);
+        }
+    }
+    return out;
+}
+
+TEST_CASE("xxh32", "[lz4_frame]") {
+    REQUIRE(spdlog::details::xxh32("", 0) == 0x02CC5D05);
+    REQUIRE(spdlog::details::xxh32("", 0, 1) != spdlog::details::xxh32("", 0));
+}
+
+TEST_CASE("lz4_frame_encoder", "[lz4_frame]") {
+    spdlog::details::lz4_frame_encoder encoder;
+    REQUIRE(encoder.block_size() == 64 * 1024);
+    REQUIRE(spdlog::details::lz4_frame_encoder(100000).block_size() == 256 * 1024);
+    REQUIRE(spdlog::details::lz4_frame_encoder(size_t{1} << 30).block_size() ==
+            4 * 1024 * 1024);
+    REQUIRE(encoder.end_frame().size() == 0);
+
+    std::mt19937 rng(42);
+    std::string input;
+    for (int i = 0; i < 5000; i++) {
+        input += spdlog::fmt_lib::format("[info] Test message {} {}\n", i, rng() % 100);
+    }
+    // incompressible
+    for (int i = 0; i < 1000; i++) {
+        input.push_back(static_cast<char>(rng()));
+    }
+    input += std::string(70000, 'z');
+    input += "tail";
+
+    std::string encoded;
+    for (size_t pos = 0; pos < input.size(); pos += encoder.block_size()) {
+        auto block = encoder.encode_block(
+            spdlog::string_view_t(input.data() + pos, (std::min)(encoder.block_size(),
+                                                                 input.size() - pos)));
+        encoded.append(block.data(), block.size());
+    }
+    auto end_mark = encoder.end_frame();
+    encoded.append(end_mark.data(), end_mark.size());
+    REQUIRE(encoded.size() < input.size() / 3);
+    REQUIRE(lz4_decode(encoded) == input);
+
+    // short blocks are stored uncompressed
+    auto block = encoder.encode_block("abc");
+    encoded.assign(block.data(), block.size());
+    end_mark = encoder.end_frame();
+    encoded.append(end_mark.data(), end_mark.size());
+    REQUIRE(lz4_decode(encoded) == "abc");
+}
+
+TEST_CASE("compressed file sink", "[lz4_frame]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(LZ4_LOG);
+    std::string expected;
+    {
+        spdlog::file_sink_options options;
+        options.compress = true;
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(
+            filename, true, spdlog::file_event_handlers{}, options);
+        spdlog::logger logger("lz4", sink);
+        logger.set_pattern("%v");
+        for (int i = 0; i < 10000; i++) {
+            logger.info("Test message {}", i);
+            expected += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+        }
+        // each flush writes a block
+        logger.flush();
+        logger.info("Last message");
+        expected += spdlog::fmt_lib::format("Last message{}", default_eol);
+        logger.flush();
+    }
+    auto contents = file_contents(LZ4_LOG);
+    REQUIRE(contents.size() < expected.size() / 3);
+    REQUIRE(lz4_decode(contents) == expected);
+
+    // appends a frame
+    {
+        spdlog::details::file_helper helper;
+        helper.set_compression(true);
+        helper.open(filename);
+        REQUIRE(helper.compressed());
+        helper.write(spdlog::string_view_t("appended"));
+    }
+    REQUIRE(lz4_decode(file_contents(LZ4_LOG)) == expected + "appended");
+}
+
+static void write_file(const char *filename, const std::string &contents) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+TEST_CASE("compression is explicit", "[lz4_frame]") {
+    prepare_logdir();
+    {
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_st>(
+            SPDLOG_FILENAME_T(LZ4_LOG));
+        spdlog::logger logger("lz4", sink);
+        logger.set_pattern("%v");
+        logger.info("plain");
+    }
+    REQUIRE(file_contents(LZ4_LOG) == spdlog::fmt_lib::format("plain{}", default_eol));
+
+    // through the factory functions
+    prepare_logdir();
+    {
+        spdlog::file_sink_options options;
+        options.compress = true;
+        auto logger = spdlog::rotating_logger_st("lz4", SPDLOG_FILENAME_T(LZ4_LOG), 1024 * 1024, 1,
+                                                 false, spdlog::file_event_handlers{}, options);
+        logger->set_pattern("%v");
+        logger->info("compressed");
+        spdlog::drop("lz4");
+    }
+    REQUIRE(lz4_decode(file_contents(LZ4_LOG)) ==
+            spdlog::fmt_lib::format("compressed{}", default_eol));
+}
+
+TEST_CASE("compressed file appended after a crash", "[lz4_frame]") {
+    prepare_logdir();
+    REQUIRE(spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs")));
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(LZ4_LOG);
+    auto append = [&] {
+        spdlog::details::file_helper helper;
+        helper.set_compression(true);
+        helper.open(filename);
+        helper.write(spdlog::string_view_t("appended"));
+    };
+
+    // the blocks written before the crash, without the end mark of the frame
+    spdlog::details::lz4_frame_encoder encoder;
+    std::string written, flushed;
+    for (int i = 0; i < 2; i++) {
+        std::string lines;
+        for (int j = 0; j < 100; j++) {
+            lines += spdlog::fmt_lib::format("Test message {} {}\n", i, j);
+        }
+        auto block = encoder.encode_block(lines);
+        written.append(block.data(), block.size());
+        flushed += lines;
+    }
+    write_file(LZ4_LOG, written);
+    append();
+    REQUIRE(lz4_decode(file_contents(LZ4_LOG)) == flushed + "appended");
+
+    // a partial block at the end is cut off
+    auto block = encoder.encode_block("the block being written");
+    write_file(LZ4_LOG, written + std::string(block.data(), block.size() - 3));
+    append();
+    REQUIRE(lz4_decode(file_contents(LZ4_LOG)) == flushed + "appended");
+
+    // so is a partial frame header, after a complete frame
+    auto end_mark = encoder.end_frame();
+    auto complete = written + std::string(end_mark.data(), end_mark.size());
+    write_file(LZ4_LOG, complete + complete.substr(0, 5));
+    append();
+    REQUIRE(lz4_decode(file_contents(LZ4_LOG)) == flushed + "appended");
+
+    // not an lz4 file: left as is
+    write_file(LZ4_LOG, "plain text");
+    REQUIRE_THROWS_AS(append(), spdlog::spdlog_ex);
+    REQUIRE(file_contents(LZ4_LOG) == "plain text");
+}
+
+TEST_CASE("compressed rotating file sink", "[lz4_frame]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(LZ4_LOG);
+    spdlog::file_sink_options options;
+    options.compress = true;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(
+        filename, 1024, 2, false, spdlog::file_event_handlers{}, options);
+    spdlog::logger logger("lz4", sink);
+    logger.set_pattern("%v");
+    std::string lines;
+    for (int i = 0; i < 100; i++) {
+        logger.info("Test message {}", i);
+        lines += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+    }
+    logger.flush();
+    // smaller than a block: max_size counts the uncompressed lines
+    auto rotated = lz4_decode(file_contents("test_logs/lz4_log.txt.1.lz4"));
+    REQUIRE(rotated.size() <= 1024);
+    REQUIRE(rotated.size() > 1024 - 20);
+    REQUIRE(lines.find(rotated) != std::string::npos);
+}
+
+TEST_CASE("compressed rotating file sink max_size", "[lz4_frame]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(LZ4_LOG);
+    spdlog::file_sink_options options;
+    options.compress = true;
+    size_t max_size = 256 * 1024;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(
+        filename, max_size, 1, false, spdlog::file_event_handlers{}, options);
+    spdlog::logger logger("lz4", sink);
+    logger.set_pattern("%v");
+    for (int i = 0; i < 200000; i++) {
+        logger.info("Test message {}", i);
+    }
+    logger.flush();
+    // max_size bounds the compressed size, once the blocks are compressed
+    auto compressed = file_contents("test_logs/lz4_log.txt.1.lz4");
+    REQUIRE(compressed.size() <= max_size);
+    REQUIRE(lz4_decode(compressed).size() > 2 * max_size);
+}
+
+TEST_CASE("lz4_compress_file", "[lz4_frame]") {
+    prepare_logdir();
+    std::string contents;
+    for (int i = 0; i < 200000; i++) {
+        contents += spdlog::fmt_lib::format("Test message {}\n", i);
+    }
+    {
+        spdlog::details::file_helper helper;
+        helper.open(SPDLOG_FILENAME_T("test_logs/plain.txt"));
+        helper.write(spdlog::string_view_t(contents));
+    }
+    spdlog::details::lz4_compress_file(SPDLOG_FILENAME_T("test_logs/plain.txt"),
+                                       SPDLOG_FILENAME_T("test_logs/plain.txt.lz4"));
+    REQUIRE(!spdlog::details::os::path_exists(SPDLOG_FILENAME_T("test_logs/plain.txt")));
+    REQUIRE(lz4_decode(file_contents("test_logs/plain.txt.lz4")) == contents);
+
+    REQUIRE_THROWS_AS(
+        spdlog::details::lz4_compress_file(SPDLOG_FILENAME_T("test_logs/missing.txt"),
+                                           SPDLOG_FILENAME_T("test_logs/missing.txt.lz4")),
+        spdlog::spdlog_ex);
+    REQUIRE(!spdlog::details::os::path_exists(SPDLOG_FILENAME_T("test_logs/missing.txt.lz4")));
+}
+
+TEST_CASE("rotating file sink compress_rotated", "[lz4_frame]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T("test_logs/rotating_log.txt");
+    spdlog::file_sink_options options;
+    options.compress_rotated = true;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(
+        filename, 1024, 2, false, spdlog::file_event_handlers{}, options);
+    spdlog::logger logger("lz4", sink);
+    logger.set_pattern("%v");
+    std::string lines;
+    for (int i = 0; i < 200; i++) {
+        logger.info("Test message {}", i);
+        lines += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+    }
+    sink->wait_rotation();
+    auto rotated1 = lz4_decode(file_contents("test_logs/rotating_log.1.txt.lz4"));
+    auto rotated2 = lz4_decode(file_contents("test_logs/rotating_log.2.txt.lz4"));
+    REQUIRE(rotated1.size() <= 1024);
+    REQUIRE(rotated1.size() > 1024 - 20);
+    REQUIRE(lines.find(rotated2 + rotated1) != std::string::npos);
+    REQUIRE(count_files("test_logs") == 3);
+}
+
+TEST_CASE("daily file sink compress_rotated", "[lz4_frame]") {
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_lz4.txt");
+    {
+        spdlog::file_sink_options options;
+        options.compress_rotated = true;
+        spdlog::sinks::daily_file_sink_st sink{
+            basename, 2, 30, true, 3, spdlog::file_event_handlers{}, options};
+        sink.set_pattern("%v");
+        // simulate messages with 24 intervals
+        for (int i = 0; i < 5; i++) {
+            spdlog::details::log_msg msg{"test", spdlog::level::info, "Hello Message"};
+            msg.time += std::chrono::seconds{24 * 3600 * i};
+            sink.log(msg);
+        }
+    }
+    // the last file + 2 compressed
+    REQUIRE(count_files("test_logs") == 3);
+    size_t compressed = 0;
+    for (const auto &entry : spdlog::details::os::dir_entries(SPDLOG_FILENAME_T("test_logs"))) {
+        auto name = spdlog::details::os::filename_to_str(entry);
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".lz4") == 0) {
+            auto path = "test_logs/" + name;
+            REQUIRE(lz4_decode(file_contents(path)) ==
+                    spdlog::fmt_lib::format("Hello Message{}", default_eol));
+            compressed++;
+        }
+    }
+    REQUIRE(compressed == 2);
+}
@@ -220,3 +220,73 @@ TEST_CASE("os::fwrite_bytes", "[os]") {
     REQUIRE(closer.fp != nullptr);
     REQUIRE_FALSE(fwrite_bytes("Hello", 5, closer.fp));
 }
+
+#ifndef _WIN32
+static bool same_tm(const std::tm &a, const std::tm &b) {
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday &&
+           a.tm_hour == b.tm_hour && a.tm_min == b.tm_min && a.tm_sec == b.tm_sec &&
+           a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday && a.tm_isdst == b.tm_isdst;
+}
+
+TEST_CASE("os::localtime across time zone transitions", "[os]") {
+    const char *prev = std::getenv("TZ");
+    std::string prev_tz = prev != nullptr ? prev : "";
+    const char *zones[] = {"EST5EDT,M3.2.0,M11.1.0", "NZST-12NZDT,M9.5.0,M4.1.0/3",
+                           "IST-5:30", "UTC0"};
+    for (auto zone : zones) {
+        ::setenv("TZ", zone, 1);
+        ::tzset();
+        size_t mismatches = 0;
+        // a new thread, for a fresh cache of the zone
+        std::thread([&mismatches] {
+            std::time_t start = 1672531200 - 24 * 3600 * 400;  // 2021-11-27
+            std::time_t prev_t = start;
+            std::tm prev_expected{};
+            ::localtime_r(&prev_t, &prev_expected);
+            for (std::time_t t = start; t < start + 24 * 3600 * 800; t += 37 * 60 + 11) {
+                std::tm expected{};
+                ::localtime_r(&t, &expected);
+                if (!same_tm(spdlog::details::os::localtime(t), expected)) {
+                    mismatches++;
+                }
+                // every second around the transitions
+                if (expected.tm_isdst != prev_expected.tm_isdst) {
+                    for (std::time_t s = prev_t; s <= t; s++) {
+                        std::tm exact{};
+                        ::localtime_r(&s, &exact);
+                        if (!same_tm(spdlog::details::os::localtime(s), exact)) {
+                            mismatches++;
+                        }
+                    }
+                }
+                prev_t = t;
+                prev_expected = expected;
+            }
+            // going back in time, as the messages of several threads seen by an async worker
+            for (std::time_t t = start + 24 * 3600 * 800; t > start; t -= 41 * 60 + 7) {
+                std::tm expected{};
+                ::localtime_r(&t, &expected);
+                if (!same_tm(spdlog::details::os::localtime(t), expected)) {
+                    mismatches++;
+                }
+            }
+            // before the epoch
+            for (std::time_t t = -24 * 3600 * 800; t < 0; t += 24 * 3600 + 3601) {
+                std::tm expected{};
+                ::localtime_r(&t, &expected);
+                if (!same_tm(spdlog::details::os::localtime(t), expected)) {
+                    mismatches++;
+                }
+            }
+        }).join();
+        INFO(zone);
+        REQUIRE(mismatches == 0);
+    }
+    if (prev != nullptr) {
+        ::setenv("TZ", prev_tz.c_str(), 1);
+    } else {
+        ::unsetenv("TZ");
+    }
+    ::tzset();
+}
+#endif
@@ -0,0 +1,93 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#ifndef _WIN32
+
+    #include "includes.h"
+    #include "spdlog/sinks/mmap_rotating_file_sink.h"
+
+    #define MMAP_LOG "test_logs/mmap_log"
+
+using spdlog::details::os::default_eol;
+
+TEST_CASE("mmap_file", "[mmap_file]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(MMAP_LOG);
+    {
+        spdlog::details::mmap_file file;
+        file.open(filename, 16);
+        REQUIRE(file.capacity() == 16);
+        file.write("0123456789");
+        // preallocated while open
+        REQUIRE(get_filesize(MMAP_LOG) == 16);
+        // grows to fit
+        file.write("0123456789");
+        REQUIRE(file.size() == 20);
+        REQUIRE(file.capacity() == 20);
+        file.flush();
+    }
+    REQUIRE(file_contents(MMAP_LOG) == "01234567890123456789");
+
+    // appends
+    {
+        spdlog::details::mmap_file file;
+        file.open(filename, 16);
+        REQUIRE(file.size() == 20);
+        file.write("!");
+        file.sync();
+    }
+    REQUIRE(file_contents(MMAP_LOG) == "01234567890123456789!");
+
+    // appends after the zeros left by a process that died before close
+    {
+        std::ofstream(MMAP_LOG, std::ios::binary | std::ios::app) << std::string(100, '\0');
+    }
+    {
+        spdlog::details::mmap_file file;
+        file.open(filename, 16);
+        REQUIRE(file.size() == 21);
+        file.write("?");
+    }
+    REQUIRE(file_contents(MMAP_LOG) == "01234567890123456789!?");
+}
+
+TEST_CASE("mmap_rotating_file_logger", "[mmap_rotating_logger]") {
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T(MMAP_LOG);
+    // room for 4 lines of "Test message N"
+    size_t line_size = std::strlen("Test message 0") + std::strlen(default_eol);
+    size_t max_size = line_size * 4;
+    {
+        auto logger = spdlog::mmap_rotating_logger_mt("logger", basename, max_size, 2);
+        logger->set_pattern("%v");
+        for (int i = 0; i < 10; ++i) {
+            logger->info("Test message {}", i);
+        }
+        spdlog::drop(logger->name());
+    }
+
+    auto lines = [](int first, int last) {
+        std::string rv;
+        for (int i = first; i < last; i++) {
+            rv += spdlog::fmt_lib::format("Test message {}{}", i, default_eol);
+        }
+        return rv;
+    };
+    REQUIRE(file_contents(MMAP_LOG) == lines(8, 10));
+    REQUIRE(file_contents(MMAP_LOG ".1") == lines(4, 8));
+    REQUIRE(file_contents(MMAP_LOG ".2") == lines(0, 4));
+
+    // rotate_on_open
+    {
+        auto logger = spdlog::mmap_rotating_logger_st("logger", basename, max_size, 2, true);
+        logger->set_pattern("%v");
+        logger->info("Test message {}", 10);
+        spdlog::drop(logger->name());
+    }
+    REQUIRE(file_contents(MMAP_LOG) == lines(10, 11));
+    REQUIRE(file_contents(MMAP_LOG ".1") == lines(8, 10));
+    REQUIRE(file_contents(MMAP_LOG ".2") == lines(4, 8));
+}
+
+#endif
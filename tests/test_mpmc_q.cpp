@@ -112,3 +112,220 @@ TEST_CASE("full_queue", "[mpmc_blocking_q]") {
     q.dequeue(item);
     REQUIRE(item == 123456);
 }
+
+TEST_CASE("dequeue_bulk", "[mpmc_blocking_q]") {
+    size_t q_size = 10;
+    spdlog::details::mpmc_blocking_queue<int> q(q_size);
+    for (int i = 0; i < 7; i++) {
+        q.enqueue(i + 0);
+    }
+
+    int items[4] = {};
+    REQUIRE(q.dequeue_bulk(items, 4) == 4);
+    REQUIRE(items[0] == 0);
+    REQUIRE(items[3] == 3);
+    REQUIRE(q.dequeue_bulk(items, 4) == 3);
+    REQUIRE(items[0] == 4);
+    REQUIRE(items[2] == 6);
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("wait_policies", "[mpmc_blocking_q]") {
+    auto wait_policy =
+        GENERATE(spdlog::async_wait_policy::block, spdlog::async_wait_policy::spin_yield_park,
+                 spdlog::async_wait_policy::busy_spin);
+    size_t items = 10000;
+    // a small queue keeps the producer waiting for room too
+    spdlog::details::mpmc_blocking_queue<size_t> q(16, wait_policy);
+    std::thread producer([&] {
+        for (size_t i = 0; i < items; i++) {
+            q.enqueue(i + 0);
+            if (i % 1000 == 0) {
+                // let the consumer go past the spinning phase
+                std::this_thread::sleep_for(milliseconds(1));
+            }
+        }
+    });
+    size_t popped[8];
+    size_t expected = 0;
+    while (expected < items) {
+        size_t count = q.dequeue_bulk(popped, 8);
+        for (size_t i = 0; i < count; i++) {
+            REQUIRE(popped[i] == expected++);
+        }
+    }
+    producer.join();
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("lockfree_capacity", "[mpmc_lockfree_q]") {
+    spdlog::details::mpmc_lockfree_queue<int> q(100);
+    REQUIRE(q.capacity() == 128);
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("lockfree_dequeue-empty-wait", "[mpmc_lockfree_q]") {
+    milliseconds wait_ms(250);
+    milliseconds tolerance_wait(250);
+
+    spdlog::details::mpmc_lockfree_queue<int> q(16);
+    int popped_item = 0;
+    auto start = test_clock::now();
+    auto rv = q.dequeue_for(popped_item, wait_ms);
+    auto delta_ms = millis_from(start);
+
+    REQUIRE(rv == false);
+    INFO("Delta " << delta_ms.count() << " millis");
+    REQUIRE(delta_ms >= wait_ms - tolerance_wait);
+    REQUIRE(delta_ms <= wait_ms + tolerance_wait);
+}
+
+TEST_CASE("lockfree_bad_queue", "[mpmc_lockfree_q]") {
+    spdlog::details::mpmc_lockfree_queue<int> q(0);
+    q.enqueue_nowait(1);
+    REQUIRE(q.overrun_counter() == 1);
+    q.enqueue_if_have_room(1);
+    REQUIRE(q.discard_counter() == 1);
+    int i = 0;
+    REQUIRE(q.dequeue_for(i, milliseconds(0)) == false);
+}
+
+TEST_CASE("lockfree_full_queue", "[mpmc_lockfree_q]") {
+    size_t q_size = 64;
+    spdlog::details::mpmc_lockfree_queue<int> q(q_size);
+    for (int i = 0; i < static_cast<int>(q_size); i++) {
+        q.enqueue(i + 0);
+    }
+    REQUIRE(q.size() == q_size);
+
+    q.enqueue_if_have_room(-1);
+    REQUIRE(q.discard_counter() == 1);
+
+    q.enqueue_nowait(123456);
+    REQUIRE(q.overrun_counter() == 1);
+
+    for (int i = 1; i < static_cast<int>(q_size); i++) {
+        int item = -1;
+        q.dequeue(item);
+        REQUIRE(item == i);
+    }
+
+    // last item pushed has overridden the oldest.
+    int item = -1;
+    q.dequeue(item);
+    REQUIRE(item == 123456);
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("lockfree_multi_producers", "[mpmc_lockfree_q]") {
+    // small queue so producers have to park until the consumer makes room
+    spdlog::details::mpmc_lockfree_queue<size_t> q(8);
+    const size_t n_threads = 4;
+    const size_t per_thread = 10000;
+
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < n_threads; t++) {
+        producers.emplace_back([&q, t, per_thread] {
+            for (size_t i = 0; i < per_thread; i++) {
+                q.enqueue(t * per_thread + i);
+            }
+        });
+    }
+
+    // each producer's items must arrive in order and none may be lost
+    std::vector<size_t> next(n_threads, 0);
+    for (size_t i = 0; i < n_threads * per_thread; i++) {
+        size_t item = 0;
+        REQUIRE(q.dequeue_for(item, milliseconds(5000)));
+        size_t t = item / per_thread;
+        REQUIRE(item % per_thread == next[t]);
+        next[t]++;
+    }
+
+    for (auto &t : producers) {
+        t.join();
+    }
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("lockfree_dequeue_bulk", "[mpmc_lockfree_q]") {
+    size_t q_size = 8;
+    spdlog::details::mpmc_lockfree_queue<int> q(q_size);
+    for (int i = 0; i < 7; i++) {
+        q.enqueue(i + 0);
+    }
+
+    int items[4] = {};
+    REQUIRE(q.dequeue_bulk(items, 4) == 4);
+    REQUIRE(items[0] == 0);
+    REQUIRE(items[3] == 3);
+    REQUIRE(q.dequeue_bulk(items, 4) == 3);
+    REQUIRE(items[0] == 4);
+    REQUIRE(items[2] == 6);
+    REQUIRE(q.size() == 0);
+}
+
+using arena_q = spdlog::details::arena_queue<int>;
+
+static void arena_push(arena_q &q, int item, const std::string &extra) {
+    q.enqueue(item + 0, extra.data(), extra.size());
+}
+
+static std::string arena_pop(arena_q &q, int &item) {
+    arena_q::record *rec = nullptr;
+    REQUIRE(q.dequeue_bulk(&rec, 1) == 1);
+    item = rec->item;
+    std::string extra(rec->extra(), rec->extra_size);
+    q.release(&rec, 1);
+    return extra;
+}
+
+TEST_CASE("arena_wrap_around", "[arena_q]") {
+    arena_q q(1024);
+    std::string extra(100, 'x');
+    // keep the queue half full while going around the arena many times
+    for (int i = 0; i < 4; i++) {
+        arena_push(q, i, extra + std::to_string(i));
+    }
+    for (int i = 4; i < 1000; i++) {
+        arena_push(q, i, extra + std::to_string(i));
+        int item = -1;
+        REQUIRE(arena_pop(q, item) == extra + std::to_string(i - 4));
+        REQUIRE(item == i - 4);
+    }
+    REQUIRE(q.size() == 4);
+    REQUIRE(q.overrun_counter() == 0);
+}
+
+TEST_CASE("arena_too_big", "[arena_q]") {
+    arena_q q(256);
+    std::string extra(q.capacity(), 'x');
+    q.enqueue_nowait(1, extra.data(), extra.size());
+    q.enqueue_if_have_room(2, extra.data(), extra.size());
+    q.enqueue(3, extra.data(), extra.size());
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.overrun_counter() == 1);
+    REQUIRE(q.discard_counter() == 2);
+}
+
+TEST_CASE("arena_overrun_and_discard", "[arena_q]") {
+    arena_q q(1024);
+    std::string extra(200, 'x');
+    for (int i = 0; i < 20; i++) {
+        q.enqueue_nowait(i + 0, extra.data(), extra.size());
+    }
+    REQUIRE(q.overrun_counter() > 0);
+    auto stored = q.size();
+    REQUIRE(stored + q.overrun_counter() == 20);
+
+    q.enqueue_if_have_room(100, extra.data(), extra.size());
+    REQUIRE(q.discard_counter() == 1);
+
+    // the newest records were kept
+    arena_q::record *recs[32];
+    REQUIRE(q.dequeue_bulk(recs, 32) == stored);
+    REQUIRE(recs[stored - 1]->item == 19);
+    REQUIRE(recs[0]->item == static_cast<int>(20 - stored));
+    q.release(recs, stored);
+    REQUIRE(q.size() == 0);
+}
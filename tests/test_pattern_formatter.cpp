@@ -630,3 +630,160 @@ TEST_CASE("mdc empty", "[pattern_formatter]") {
     SECTION("Tear down") { spdlog::mdc::clear(); }
 }
 #endif
+
+static std::string format_at(spdlog::formatter &formatter, spdlog::log_clock::time_point time) {
+    memory_buf_t formatted;
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info,
+                                 "some message");
+    msg.time = time;
+    formatter.format(msg, formatted);
+    return std::string(formatted.data(), formatted.size());
+}
+
+static std::string expected_time(spdlog::log_clock::time_point time, const char *tail) {
+    auto tm = spdlog::details::os::localtime(spdlog::log_clock::to_time_t(time));
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch());
+    return spdlog::fmt_lib::format("[{:04d}-{:02d}-{:02d} {:02d}:{:02d}:{:02d}.{:03d}] {}",
+                                   tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                                   tm.tm_min, tm.tm_sec, millis.count() % 1000, tail);
+}
+
+TEST_CASE("time flags rendered once per second", "[pattern_formatter]") {
+    spdlog::pattern_formatter formatter("[%Y-%m-%d %H:%M:%S.%e] %v",
+                                        spdlog::pattern_time_type::local, "");
+    auto time = spdlog::log_clock::from_time_t(1700000000) + std::chrono::milliseconds(123);
+    REQUIRE(format_at(formatter, time) == expected_time(time, "some message"));
+    time += std::chrono::milliseconds(500);
+    REQUIRE(format_at(formatter, time) == expected_time(time, "some message"));
+    time += std::chrono::milliseconds(500);
+    REQUIRE(format_at(formatter, time) == expected_time(time, "some message"));
+    time -= std::chrono::hours(25);
+    REQUIRE(format_at(formatter, time) == expected_time(time, "some message"));
+}
+
+TEST_CASE("fused default patterns", "[pattern_formatter]") {
+    auto time = spdlog::log_clock::from_time_t(1700000000) + std::chrono::milliseconds(7);
+    spdlog::pattern_formatter formatter("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v",
+                                        spdlog::pattern_time_type::local, "");
+    REQUIRE(format_at(formatter, time) ==
+            expected_time(time, "[logger-name] [info] some message"));
+
+    spdlog::pattern_formatter color_formatter("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v",
+                                              spdlog::pattern_time_type::local, "");
+    memory_buf_t formatted;
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info,
+                                 "some message");
+    msg.time = time;
+    color_formatter.format(msg, formatted);
+    REQUIRE(to_string_view(formatted) == expected_time(time, "[logger-name] [info] some message"));
+    REQUIRE(msg.color_range_start == 41);
+    REQUIRE(msg.color_range_end == 45);
+}
+
+TEST_CASE("padding of the compiled flags", "[pattern_formatter]") {
+    REQUIRE(log_to_str("Some message", "[%8l] [%-8l] [%=8l] [%=7L] [%2!l] [%3n]",
+                       spdlog::pattern_time_type::local, "") ==
+            "[    info] [info    ] [  info  ] [   I   ] [in] [pattern_tester]");
+    REQUIRE(log_to_str("Some message", "[%-15!v] [%%] [%5%]", spdlog::pattern_time_type::local,
+                       "") == "[Some message   ] [%] [%]");
+    auto tm = spdlog::details::os::localtime();
+    REQUIRE(log_to_str("Some message", "[%=6Y]", spdlog::pattern_time_type::local, "") ==
+            spdlog::fmt_lib::format("[ {} ]", tm.tm_year + 1900));
+}
+
+TEST_CASE("long literals", "[pattern_formatter]") {
+    std::string literal(600, 'x');
+    REQUIRE(log_to_str("Some message", literal + "%v" + literal, spdlog::pattern_time_type::local,
+                       "") == literal + "Some message" + literal);
+}
+
+TEST_CASE("custom flags override the compiled flags", "[pattern_formatter]") {
+    auto formatter = std::make_shared<spdlog::pattern_formatter>();
+    formatter->add_flag<custom_test_flag>('l', "custom-level")
+        .add_flag<custom_test_flag>('%', "custom-percent")
+        .set_pattern("[%l] [%%] %v");
+    memory_buf_t formatted;
+    spdlog::details::log_msg msg(spdlog::source_loc{}, "logger-name", spdlog::level::info,
+                                 "some message");
+    formatter->format(msg, formatted);
+    REQUIRE(to_string_view(formatted) ==
+            spdlog::fmt_lib::format("[custom-level] [custom-percent] some message{}",
+                                    spdlog::details::os::default_eol));
+}
+
+TEST_CASE("timestamp cache", "[pattern_formatter]") {
+    using spdlog::details::timestamp_cache;
+    auto &cache = timestamp_cache::instance();
+    auto time = spdlog::log_clock::from_time_t(1800000000) + std::chrono::milliseconds(250);
+
+    auto timestamp = cache.get(time, spdlog::pattern_time_type::local);
+    REQUIRE(timestamp->secs == std::chrono::seconds(1800000000));
+    REQUIRE(to_string_view(timestamp->datetime) ==
+            expected_time(time, "").substr(1, 19));  // "YYYY-MM-DD HH:MM:SS"
+    REQUIRE(timestamp->utc_offset_minutes ==
+            spdlog::details::os::utc_minutes_offset(timestamp->tm));
+    // shared in the second
+    REQUIRE(cache.get(time + std::chrono::milliseconds(700), spdlog::pattern_time_type::local) ==
+            timestamp);
+    auto utc = cache.get(time, spdlog::pattern_time_type::utc);
+    REQUIRE(utc != timestamp);
+    REQUIRE(utc->tm.tm_hour == spdlog::details::os::gmtime(1800000000).tm_hour);
+
+    // a late message doesn't replace the last second
+    auto next = cache.get(time + std::chrono::seconds(1), spdlog::pattern_time_type::local);
+    REQUIRE(next->secs == std::chrono::seconds(1800000001));
+    REQUIRE(cache.get(time, spdlog::pattern_time_type::local)->secs ==
+            std::chrono::seconds(1800000000));
+    REQUIRE(cache.get(time + std::chrono::seconds(1), spdlog::pattern_time_type::local) == next);
+}
+
+TEST_CASE("formatters share the timestamp cache", "[pattern_formatter]") {
+    auto time = spdlog::log_clock::from_time_t(1800000100) + std::chrono::milliseconds(5);
+    spdlog::pattern_formatter formatter("%Y-%m-%d %H:%M:%S %z", spdlog::pattern_time_type::utc,
+                                        "");
+    auto cloned = formatter.clone();
+    REQUIRE(format_at(formatter, time) == format_at(*cloned, time));
+    auto timestamp =
+        spdlog::details::timestamp_cache::instance().get(time, spdlog::pattern_time_type::utc);
+    auto offset = timestamp->utc_offset_minutes;
+    REQUIRE(format_at(formatter, time) ==
+            spdlog::fmt_lib::format("{} {}{:02d}:{:02d}", to_string_view(timestamp->datetime),
+                                    offset < 0 ? '-' : '+', std::abs(offset) / 60,
+                                    std::abs(offset) % 60));
+
+    // the full formatter uses its rendered date time
+    spdlog::pattern_formatter full_formatter(spdlog::pattern_time_type::utc, "");
+    REQUIRE(format_at(full_formatter, time).substr(0, 25) ==
+            spdlog::fmt_lib::format("[{}.005]", to_string_view(timestamp->datetime)));
+}
+
+// built before the timestamp cache, so destroyed after it if the cache were a plain function
+// local static: formats from its destructor, as a logger used at exit would.
+// a destroyed cache is reported by the address sanitizer (SPDLOG_SANITIZE_ADDRESS).
+struct format_at_exit {
+    std::unique_ptr<spdlog::formatter> formatter;
+    bool armed = false;
+
+    format_at_exit()
+        : formatter(spdlog::details::make_unique<spdlog::pattern_formatter>(
+              "%Y-%m-%d %H:%M:%S", spdlog::pattern_time_type::utc, "")) {}
+
+    ~format_at_exit() {
+        if (!armed) {
+            return;
+        }
+        // a second newer than any other in the tests, to replace the cached one
+        auto time = spdlog::log_clock::from_time_t(2000000000);
+        if (format_at(*formatter, time) != "2033-05-18 03:33:20") {
+            std::abort();
+        }
+    }
+};
+
+static format_at_exit s_format_at_exit;
+
+TEST_CASE("timestamp cache outlives the statics", "[pattern_formatter]") {
+    REQUIRE(format_at(*s_format_at_exit.formatter, spdlog::log_clock::from_time_t(1800000200)) ==
+            "2027-01-15 08:03:20");
+    s_format_at_exit.armed = true;
+}
@@ -0,0 +1,188 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "spdlog/sinks/ansicolor_sink.h"
+
+#include <atomic>
+
+using spdlog::memory_buf_t;
+using spdlog::details::os::default_eol;
+
+// counts the messages it formats
+class counting_formatter final : public spdlog::formatter {
+public:
+    counting_formatter(std::shared_ptr<std::atomic<int>> count, std::string key)
+        : count_(std::move(count)),
+          key_(std::move(key)) {}
+
+    void format(const spdlog::details::log_msg &msg, memory_buf_t &dest) override {
+        ++*count_;
+        dest.append(key_.data(), key_.data() + key_.size());
+        dest.append(msg.payload.begin(), msg.payload.end());
+        dest.push_back('\n');
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override {
+        return spdlog::details::make_unique<counting_formatter>(count_, key_);
+    }
+
+    std::string format_key() const override { return key_; }
+
+private:
+    std::shared_ptr<std::atomic<int>> count_;
+    std::string key_;
+};
+
+class star_flag final : public spdlog::custom_flag_formatter {
+public:
+    void format(const spdlog::details::log_msg &, const std::tm &, memory_buf_t &dest) override {
+        dest.push_back('*');
+    }
+
+    std::unique_ptr<custom_flag_formatter> clone() const override {
+        return spdlog::details::make_unique<star_flag>();
+    }
+};
+
+static std::shared_ptr<spdlog::sinks::ostream_sink_mt> counting_sink(
+    std::ostringstream &oss, std::shared_ptr<std::atomic<int>> count, std::string key) {
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    sink->set_formatter(
+        spdlog::details::make_unique<counting_formatter>(std::move(count), std::move(key)));
+    return sink;
+}
+
+TEST_CASE("format key", "[shared_format]") {
+    using spdlog::pattern_formatter;
+    using spdlog::pattern_time_type;
+    REQUIRE(pattern_formatter("%v").format_key() == pattern_formatter("%v").format_key());
+    REQUIRE(pattern_formatter("%v").format_key() != pattern_formatter("%v!").format_key());
+    REQUIRE(pattern_formatter("%v", pattern_time_type::local, "\n").format_key() !=
+            pattern_formatter("%v", pattern_time_type::local, "\r\n").format_key());
+    REQUIRE(pattern_formatter("%v", pattern_time_type::local).format_key() !=
+            pattern_formatter("%v", pattern_time_type::utc).format_key());
+    REQUIRE(pattern_formatter("%v").clone()->format_key() == pattern_formatter("%v").format_key());
+
+    // without the local time, the time flags print the time of an older message
+    pattern_formatter without_localtime("%H:%M:%S %v");
+    without_localtime.need_localtime(false);
+    REQUIRE(without_localtime.format_key() != pattern_formatter("%H:%M:%S %v").format_key());
+
+    pattern_formatter with_custom_flag;
+    with_custom_flag.add_flag<star_flag>('*');
+    REQUIRE(with_custom_flag.format_key().empty());
+}
+
+TEST_CASE("format once for equivalent formatters", "[shared_format]") {
+    auto count = std::make_shared<std::atomic<int>>(0);
+    std::ostringstream oss1, oss2, oss3;
+    spdlog::logger logger("shared", {counting_sink(oss1, count, "a:"),
+                                     counting_sink(oss2, count, "b:"),
+                                     counting_sink(oss3, count, "a:")});
+
+    logger.info("Hello");
+    logger.info("World");
+
+    REQUIRE(count->load() == 4);
+    REQUIRE(oss1.str() == "a:Hello\na:World\n");
+    REQUIRE(oss2.str() == "b:Hello\nb:World\n");
+    REQUIRE(oss3.str() == "a:Hello\na:World\n");
+}
+
+TEST_CASE("format once with sink levels", "[shared_format]") {
+    auto count = std::make_shared<std::atomic<int>>(0);
+    std::ostringstream oss1, oss2;
+    auto sink1 = counting_sink(oss1, count, "a:");
+    auto sink2 = counting_sink(oss2, count, "a:");
+    sink1->set_level(spdlog::level::warn);
+    spdlog::logger logger("shared", {sink1, sink2});
+
+    logger.info("Hello");
+    logger.warn("World");
+
+    REQUIRE(count->load() == 2);
+    REQUIRE(oss1.str() == "a:World\n");
+    REQUIRE(oss2.str() == "a:Hello\na:World\n");
+}
+
+TEST_CASE("shared pattern", "[shared_format]") {
+    std::ostringstream oss1, oss2;
+    auto sink1 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss1);
+    auto sink2 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss2);
+    spdlog::logger logger("shared", {sink1, sink2});
+    logger.set_pattern("[%n] %v");
+
+    logger.info("Hello");
+    REQUIRE(oss1.str() == spdlog::fmt_lib::format("[shared] Hello{}", default_eol));
+    REQUIRE(oss2.str() == oss1.str());
+
+    // the sinks don't share anymore
+    sink2->set_pattern("%v!");
+    logger.info("World");
+    REQUIRE(oss1.str() ==
+            spdlog::fmt_lib::format("[shared] Hello{}[shared] World{}", default_eol, default_eol));
+    REQUIRE(oss2.str() ==
+            spdlog::fmt_lib::format("[shared] Hello{}World!{}", default_eol, default_eol));
+}
+
+TEST_CASE("shared format color range", "[shared_format]") {
+    std::ostringstream oss1, oss2;
+    auto sink1 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss1);
+    auto sink2 = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss2);
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    auto color_sink =
+        std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_mutex>>(
+            file, spdlog::color_mode::always);
+    color_sink->set_color(spdlog::level::info, "<c>");
+    // sink2 formats with a different color range between sink1 and color_sink
+    spdlog::logger logger("shared", {sink1, sink2, spdlog::sink_ptr(color_sink)});
+    logger.set_pattern("[%^%l%$] %v");
+    sink2->set_pattern("%^%v%$");
+
+    logger.info("Hello");
+
+    std::fflush(file);
+    std::rewind(file);
+    char buf[128] = {};
+    auto size = std::fread(buf, 1, sizeof(buf) - 1, file);
+    std::fclose(file);
+    REQUIRE(std::string(buf, size) ==
+            spdlog::fmt_lib::format("[<c>info\033[m] Hello{}", default_eol));
+    REQUIRE(oss1.str() == spdlog::fmt_lib::format("[info] Hello{}", default_eol));
+}
+
+TEST_CASE("shared format async batch", "[shared_format]") {
+    auto count = std::make_shared<std::atomic<int>>(0);
+    std::ostringstream oss1, oss2, oss3;
+    auto sink3 = counting_sink(oss3, count, "a:");
+    sink3->set_level(spdlog::level::warn);
+    std::vector<spdlog::sink_ptr> sinks{counting_sink(oss1, count, "a:"),
+                                        counting_sink(oss2, count, "a:"), sink3};
+    {
+        spdlog::thread_pool_options options;
+        options.max_batch_size = 16;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(128, 1, options);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "shared", sinks.begin(), sinks.end(), tp, spdlog::async_overflow_policy::block);
+        for (int i = 0; i < 10; i++) {
+            logger->info("Hello {}", i);
+        }
+        logger->warn("World");
+        logger->flush();
+    }
+
+    std::string expected;
+    for (int i = 0; i < 10; i++) {
+        expected += spdlog::fmt_lib::format("a:Hello {}\n", i);
+    }
+    expected += "a:World\n";
+    REQUIRE(oss1.str() == expected);
+    REQUIRE(oss2.str() == expected);
+    REQUIRE(oss3.str() == "a:World\n");
+    // once, and once more for "World" if sink3 got it in a batch with other messages
+    REQUIRE(count->load() >= 11);
+    REQUIRE(count->load() <= 12);
+}
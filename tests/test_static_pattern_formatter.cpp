@@ -0,0 +1,97 @@
+#include "includes.h"
+#include "test_sink.h"
+
+// needs C++17
+#ifdef SPDLOG_STATIC_PATTERN
+
+using spdlog::memory_buf_t;
+using spdlog::details::to_string_view;
+
+static spdlog::details::log_msg test_msg(spdlog::log_clock::time_point time) {
+    spdlog::details::log_msg msg(time, spdlog::source_loc{"/some/dir/file.cpp", 42, "func"},
+                                 "logger-name", spdlog::level::warn, "test message");
+    msg.thread_id = 1234;
+    return msg;
+}
+
+// the static formatter of the pattern must format like pattern_formatter
+template <typename Pattern>
+static void require_same_output(Pattern pattern) {
+    auto static_formatter = spdlog::make_static_pattern_formatter(pattern);
+    spdlog::pattern_formatter formatter(Pattern::value());
+    auto now = spdlog::log_clock::now();
+    for (auto time : {now, now + std::chrono::milliseconds(1500)}) {
+        auto msg = test_msg(time);
+        memory_buf_t expected, formatted;
+        formatter.format(msg, expected);
+        auto expected_range = std::make_pair(msg.color_range_start, msg.color_range_end);
+        msg.color_range_start = msg.color_range_end = 0;
+        static_formatter->format(msg, formatted);
+        INFO("pattern: " << Pattern::value());
+        REQUIRE(to_string_view(formatted) == to_string_view(expected));
+        REQUIRE(std::make_pair(msg.color_range_start, msg.color_range_end) == expected_range);
+    }
+}
+
+TEST_CASE("static pattern formatter output", "[static_pattern_formatter]") {
+    require_same_output(SPDLOG_STATIC_PATTERN(""));
+    require_same_output(SPDLOG_STATIC_PATTERN("plain text"));
+    require_same_output(SPDLOG_STATIC_PATTERN("%+"));
+    require_same_output(SPDLOG_STATIC_PATTERN("[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v"));
+    require_same_output(SPDLOG_STATIC_PATTERN("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v"));
+    require_same_output(SPDLOG_STATIC_PATTERN("%a %A %b %h %B %c %C %D %x %I %p %r %R %T %X"));
+    require_same_output(SPDLOG_STATIC_PATTERN("%e %f %F %E %z %P %t %L"));
+    require_same_output(SPDLOG_STATIC_PATTERN("%@ %s %g %# %!"));
+    require_same_output(SPDLOG_STATIC_PATTERN("100%% %q %5k %%% %"));
+    require_same_output(SPDLOG_STATIC_PATTERN("[%8n] [%-8l] [%=8v] [%3!v] [%-3!n] [%=2!l]"));
+    require_same_output(SPDLOG_STATIC_PATTERN("[%10s] [%-20@] [%=6#] [%3!!] [%10!] %3!q"));
+    require_same_output(SPDLOG_STATIC_PATTERN("[%99Y] [%5t] [%=9e] [%0!v] [%-x"));
+    require_same_output(SPDLOG_STATIC_PATTERN("%E.%e %Y%m%d%% %=12T %z %H:%M"));
+}
+
+TEST_CASE("static pattern formatter elapsed flags", "[static_pattern_formatter]") {
+    auto formatter = spdlog::make_static_pattern_formatter(SPDLOG_STATIC_PATTERN("%o %i %u %O"),
+                                                           spdlog::pattern_time_type::local, "");
+    auto now = spdlog::log_clock::now();
+    memory_buf_t formatted;
+    formatter->format(test_msg(now), formatted);
+    formatted.clear();
+    formatter->format(test_msg(now + std::chrono::milliseconds(2005)), formatted);
+    REQUIRE(to_string_view(formatted) == "2005 2005000 2005000000 2");
+    // no negative delta
+    formatted.clear();
+    formatter->format(test_msg(now), formatted);
+    REQUIRE(to_string_view(formatted) == "0 0 0 0");
+}
+
+TEST_CASE("static pattern formatter in a sink", "[static_pattern_formatter]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("static", test_sink);
+    test_sink->set_formatter(spdlog::make_static_pattern_formatter(
+        SPDLOG_STATIC_PATTERN("[%n] [%l] %v"), spdlog::pattern_time_type::utc, "\n"));
+    logger.info("Hello {}", 42);
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"[static] [info] Hello 42"});
+
+    // shares the formatted message with the equivalent pattern_formatter
+    auto formatter = spdlog::make_static_pattern_formatter(SPDLOG_STATIC_PATTERN("[%n] %v"));
+    REQUIRE(formatter->format_key() == spdlog::pattern_formatter("[%n] %v").format_key());
+    REQUIRE(formatter->format_key() != spdlog::pattern_formatter("[%n]%v").format_key());
+    REQUIRE(spdlog::make_static_pattern_formatter(SPDLOG_STATIC_PATTERN("%T %v"))->format_key() ==
+            spdlog::pattern_formatter("%T %v").format_key());
+    auto cloned = formatter->clone();
+    memory_buf_t formatted;
+    cloned->format(test_msg(spdlog::log_clock::now()), formatted);
+    REQUIRE(to_string_view(formatted) ==
+            std::string("[logger-name] test message") + spdlog::details::os::default_eol);
+}
+
+    #if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+TEST_CASE("static pattern formatter template argument", "[static_pattern_formatter]") {
+    spdlog::static_pattern_formatter<"[%-6l] %v"> formatter(spdlog::pattern_time_type::local, "");
+    memory_buf_t formatted;
+    formatter.format(test_msg(spdlog::log_clock::now()), formatted);
+    REQUIRE(to_string_view(formatted) == "[warning] test message");
+}
+    #endif
+
+#endif